@@ -429,6 +429,8 @@ struct hash
     ULONG             secret_len;
     struct hash_impl  outer;
     struct hash_impl  inner;
+    struct hash_impl  outer_init;  /* keyed state to restart reusable hashes from */
+    struct hash_impl  inner_init;
 };
 
 #define BLOCK_LENGTH_AES        16
@@ -678,7 +680,11 @@ static NTSTATUS prepare_hash( struct hash *hash )
 
     /* initialize hash */
     if ((status = hash_init( &hash->inner, hash->alg_id ))) return status;
-    if (!(hash->flags & HASH_FLAG_HMAC)) return STATUS_SUCCESS;
+    if (!(hash->flags & HASH_FLAG_HMAC))
+    {
+        hash->inner_init = hash->inner;
+        return STATUS_SUCCESS;
+    }
 
     /* initialize hmac */
     if ((status = hash_init( &hash->outer, hash->alg_id ))) return status;
@@ -696,7 +702,38 @@ static NTSTATUS prepare_hash( struct hash *hash )
     for (i = 0; i < block_bytes; i++) buffer[i] ^= 0x5c;
     if ((status = hash_update( &hash->outer, hash->alg_id, buffer, block_bytes ))) return status;
     for (i = 0; i < block_bytes; i++) buffer[i] ^= (0x5c ^ 0x36);
-    return hash_update( &hash->inner, hash->alg_id, buffer, block_bytes );
+    if ((status = hash_update( &hash->inner, hash->alg_id, buffer, block_bytes ))) return status;
+
+    hash->outer_init = hash->outer;
+    hash->inner_init = hash->inner;
+    return STATUS_SUCCESS;
+}
+
+static void reset_hash( struct hash *hash )
+{
+    hash->inner = hash->inner_init;
+    if (hash->flags & HASH_FLAG_HMAC) hash->outer = hash->outer_init;
+}
+
+static NTSTATUS finish_hash( struct hash *hash, UCHAR *output, ULONG size )
+{
+    UCHAR buffer[MAX_HASH_OUTPUT_BYTES];
+    NTSTATUS status;
+    int hash_length;
+
+    if (!(hash->flags & HASH_FLAG_HMAC))
+    {
+        if ((status = hash_finish( &hash->inner, hash->alg_id, output, size ))) return status;
+        if (hash->flags & HASH_FLAG_REUSABLE) reset_hash( hash );
+        return STATUS_SUCCESS;
+    }
+
+    hash_length = builtin_algorithms[hash->alg_id].hash_length;
+    if ((status = hash_finish( &hash->inner, hash->alg_id, buffer, hash_length ))) return status;
+    if ((status = hash_update( &hash->outer, hash->alg_id, buffer, hash_length ))) return status;
+    if ((status = hash_finish( &hash->outer, hash->alg_id, output, size ))) return status;
+    if (hash->flags & HASH_FLAG_REUSABLE) reset_hash( hash );
+    return STATUS_SUCCESS;
 }
 
 NTSTATUS WINAPI BCryptCreateHash( BCRYPT_ALG_HANDLE algorithm, BCRYPT_HASH_HANDLE *handle, UCHAR *object, ULONG objectlen,
@@ -797,29 +834,14 @@ NTSTATUS WINAPI BCryptHashData( BCRYPT_HASH_HANDLE handle, UCHAR *input, ULONG s
 
 NTSTATUS WINAPI BCryptFinishHash( BCRYPT_HASH_HANDLE handle, UCHAR *output, ULONG size, ULONG flags )
 {
-    UCHAR buffer[MAX_HASH_OUTPUT_BYTES];
     struct hash *hash = handle;
-    NTSTATUS status;
-    int hash_length;
 
     TRACE( "%p, %p, %u, %08x\n", handle, output, size, flags );
 
     if (!hash || hash->hdr.magic != MAGIC_HASH) return STATUS_INVALID_HANDLE;
     if (!output) return STATUS_INVALID_PARAMETER;
 
-    if (!(hash->flags & HASH_FLAG_HMAC))
-    {
-        if ((status = hash_finish( &hash->inner, hash->alg_id, output, size ))) return status;
-        if (hash->flags & HASH_FLAG_REUSABLE) return prepare_hash( hash );
-        return STATUS_SUCCESS;
-    }
-
-    hash_length = builtin_algorithms[hash->alg_id].hash_length;
-    if ((status = hash_finish( &hash->inner, hash->alg_id, buffer, hash_length ))) return status;
-    if ((status = hash_update( &hash->outer, hash->alg_id, buffer, hash_length ))) return status;
-    if ((status = hash_finish( &hash->outer, hash->alg_id, output, size ))) return status;
-    if (hash->flags & HASH_FLAG_REUSABLE) return prepare_hash( hash );
-    return STATUS_SUCCESS;
+    return finish_hash( hash, output, size );
 }
 
 NTSTATUS WINAPI BCryptHash( BCRYPT_ALG_HANDLE algorithm, UCHAR *secret, ULONG secretlen,
@@ -1729,61 +1751,98 @@ NTSTATUS WINAPI BCryptDeriveKeyCapi( BCRYPT_HASH_HANDLE handle, BCRYPT_ALG_HANDL
     return STATUS_SUCCESS;
 }
 
-static NTSTATUS pbkdf2( BCRYPT_HASH_HANDLE handle, UCHAR *pwd, ULONG pwd_len, UCHAR *salt, ULONG salt_len,
-                        ULONGLONG iterations, ULONG i, UCHAR *dst, ULONG hash_len )
+static NTSTATUS pbkdf2( struct hash *hash, UCHAR *salt, ULONG salt_len, ULONGLONG iterations, ULONG i,
+                        UCHAR *dst, ULONG hash_len )
 {
-    NTSTATUS status = STATUS_INVALID_PARAMETER;
-    UCHAR bytes[4], *buf;
-    ULONG j, k;
-
-    if (!(buf = heap_alloc( hash_len ))) return STATUS_NO_MEMORY;
+    UCHAR bytes[4], buf[MAX_HASH_OUTPUT_BYTES];
+    NTSTATUS status;
+    ULONGLONG j;
+    ULONG k;
 
     for (j = 0; j < iterations; j++)
     {
         if (j == 0)
         {
             /* use salt || INT(i) */
-            status = BCryptHashData( handle, salt, salt_len, 0 );
-            if (status != STATUS_SUCCESS)
-            {
-                heap_free( buf );
-                return status;
-            }
+            if (salt && (status = hash_update( &hash->inner, hash->alg_id, salt, salt_len ))) return status;
             bytes[0] = (i >> 24) & 0xff;
             bytes[1] = (i >> 16) & 0xff;
             bytes[2] = (i >> 8) & 0xff;
             bytes[3] = i & 0xff;
-            status = BCryptHashData( handle, bytes, 4, 0 );
-        }
-        else status = BCryptHashData( handle, buf, hash_len, 0 ); /* use U_j */
-        if (status != STATUS_SUCCESS)
-        {
-            heap_free( buf );
-            return status;
+            status = hash_update( &hash->inner, hash->alg_id, bytes, 4 );
         }
+        else status = hash_update( &hash->inner, hash->alg_id, buf, hash_len ); /* use U_j */
+        if (status) return status;
 
-        status = BCryptFinishHash( handle, buf, hash_len, 0 );
-        if (status != STATUS_SUCCESS)
-        {
-            heap_free( buf );
-            return status;
-        }
+        if ((status = finish_hash( hash, buf, hash_len ))) return status;
 
         if (j == 0) memcpy( dst, buf, hash_len );
         else for (k = 0; k < hash_len; k++) dst[k] ^= buf[k];
     }
 
-    heap_free( buf );
-    return status;
+    return STATUS_SUCCESS;
+}
+
+struct pbkdf2_params
+{
+    const struct hash *hash;
+    UCHAR             *salt;
+    ULONG              salt_len;
+    ULONGLONG          iterations;
+    UCHAR             *dk;
+    ULONG              dk_len;
+    ULONG              block_count;
+    LONG               next_block;
+    LONG               workers;
+    HANDLE             done;
+    NTSTATUS           status;
+};
+
+static void pbkdf2_blocks( struct pbkdf2_params *params )
+{
+    ULONG hash_len = builtin_algorithms[params->hash->alg_id].hash_length;
+    UCHAR partial[MAX_HASH_OUTPUT_BYTES];
+    struct hash hash = *params->hash;
+    NTSTATUS status;
+    ULONG i;
+
+    /* output blocks are independent, so every thread works on its own copy of the keyed hash */
+    while ((i = InterlockedIncrement( &params->next_block )) <= params->block_count)
+    {
+        if (params->status) break;
+
+        if (i < params->block_count)
+            status = pbkdf2( &hash, params->salt, params->salt_len, params->iterations, i,
+                             params->dk + (i - 1) * hash_len, hash_len );
+        else if (!(status = pbkdf2( &hash, params->salt, params->salt_len, params->iterations, i,
+                                    partial, hash_len )))
+            memcpy( params->dk + (i - 1) * hash_len, partial, params->dk_len - (i - 1) * hash_len );
+
+        if (status)
+        {
+            params->status = status;
+            break;
+        }
+    }
+}
+
+static DWORD CALLBACK pbkdf2_worker( void *arg )
+{
+    struct pbkdf2_params *params = arg;
+
+    pbkdf2_blocks( params );
+    if (!InterlockedDecrement( &params->workers )) SetEvent( params->done );
+    return 0;
 }
 
 NTSTATUS WINAPI BCryptDeriveKeyPBKDF2( BCRYPT_ALG_HANDLE handle, UCHAR *pwd, ULONG pwd_len, UCHAR *salt, ULONG salt_len,
                                        ULONGLONG iterations, UCHAR *dk, ULONG dk_len, ULONG flags )
 {
     struct algorithm *alg = handle;
-    ULONG hash_len, block_count, bytes_left, i;
+    struct pbkdf2_params params;
+    ULONG hash_len, i, threads;
     BCRYPT_HASH_HANDLE hash;
-    UCHAR *partial;
+    SYSTEM_INFO si;
     NTSTATUS status;
 
     TRACE( "%p, %p, %u, %p, %u, %s, %p, %u, %08x\n", handle, pwd, pwd_len, salt, salt_len,
@@ -1793,44 +1852,46 @@ NTSTATUS WINAPI BCryptDeriveKeyPBKDF2( BCRYPT_ALG_HANDLE handle, UCHAR *pwd, ULO
 
     hash_len = builtin_algorithms[alg->id].hash_length;
     if (dk_len <= 0 || dk_len > ((((ULONGLONG)1) << 32) - 1) * hash_len) return STATUS_INVALID_PARAMETER;
-
-    block_count = 1 + ((dk_len - 1) / hash_len); /* ceil(dk_len / hash_len) */
-    bytes_left = dk_len - (block_count - 1) * hash_len;
+    if (!iterations) return STATUS_INVALID_PARAMETER;
 
     status = BCryptCreateHash( handle, &hash, NULL, 0, pwd, pwd_len, BCRYPT_HASH_REUSABLE_FLAG );
     if (status != STATUS_SUCCESS)
         return status;
 
-    /* full blocks */
-    for (i = 1; i < block_count; i++)
-    {
-        status = pbkdf2( hash, pwd, pwd_len, salt, salt_len, iterations, i, dk + ((i - 1) * hash_len), hash_len );
-        if (status != STATUS_SUCCESS)
+    params.hash        = hash;
+    params.salt        = salt;
+    params.salt_len    = salt_len;
+    params.iterations  = iterations;
+    params.dk          = dk;
+    params.dk_len      = dk_len;
+    params.block_count = 1 + ((dk_len - 1) / hash_len); /* ceil(dk_len / hash_len) */
+    params.next_block  = 0;
+    params.workers     = 1;
+    params.done        = NULL;
+    params.status      = STATUS_SUCCESS;
+
+    /* spread the output blocks over the available processors */
+    GetSystemInfo( &si );
+    threads = min( params.block_count, si.dwNumberOfProcessors );
+    if (threads > 1 && (params.done = CreateEventW( NULL, TRUE, FALSE, NULL )))
+    {
+        for (i = 1; i < threads; i++)
         {
-            BCryptDestroyHash( hash );
-            return status;
+            InterlockedIncrement( &params.workers );
+            if (!QueueUserWorkItem( pbkdf2_worker, &params, WT_EXECUTEDEFAULT ))
+            {
+                InterlockedDecrement( &params.workers );
+                break;
+            }
         }
     }
 
-    /* final partial block */
-    if (!(partial = heap_alloc( hash_len )))
-    {
-        BCryptDestroyHash( hash );
-        return STATUS_NO_MEMORY;
-    }
-
-    status = pbkdf2( hash, pwd, pwd_len, salt, salt_len, iterations, block_count, partial, hash_len );
-    if (status != STATUS_SUCCESS)
-    {
-        BCryptDestroyHash( hash );
-        heap_free( partial );
-        return status;
-    }
-    memcpy( dk + ((block_count - 1) * hash_len), partial, bytes_left );
+    pbkdf2_blocks( &params );
+    if (InterlockedDecrement( &params.workers )) WaitForSingleObject( params.done, INFINITE );
+    if (params.done) CloseHandle( params.done );
 
     BCryptDestroyHash( hash );
-    heap_free( partial );
-    return STATUS_SUCCESS;
+    return params.status;
 }
 
 NTSTATUS WINAPI BCryptSecretAgreement(BCRYPT_KEY_HANDLE handle, BCRYPT_KEY_HANDLE key, BCRYPT_SECRET_HANDLE *secret, ULONG flags)
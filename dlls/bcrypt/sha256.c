@@ -42,11 +42,115 @@ static const DWORD K[64] =
   0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
 };
 
+#if defined(__x86_64__) && defined(__GNUC__)
+
+static int have_shani(void)
+{
+    static int shani = -1;
+    unsigned int a, b, c, d;
+
+    if (shani == -1)
+    {
+        __asm__ ("cpuid" : "=a" (a), "=b" (b), "=c" (c), "=d" (d) : "a" (0), "c" (0));
+        shani = 0;
+        if (a >= 7)
+        {
+            __asm__ ("cpuid" : "=a" (a), "=b" (b), "=c" (c), "=d" (d) : "a" (7), "c" (0));
+            shani = (b >> 29) & 1;
+        }
+    }
+    return shani;
+}
+
+/* Same as processblock below, using the SHA extensions. The message schedule is
+ * expanded into W first; the state is kept as ABEF and CDGH halves, which is
+ * the layout sha256rnds2 works on. */
+static void processblock_shani(SHA256_CTX *ctx, const UCHAR *buffer)
+{
+    static const UCHAR bswap_mask[16] = {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12};
+    DWORD W[64];
+    const DWORD *w = W, *k = K;
+    DWORD *p = W;
+    int count;
+
+    __asm__ __volatile__ (
+        "movdqu (%[mask]), %%xmm7\n\t"
+        "movdqu (%[buf]), %%xmm3\n\t"
+        "pshufb %%xmm7, %%xmm3\n\t"
+        "movdqu %%xmm3, (%[p])\n\t"
+        "movdqu 16(%[buf]), %%xmm3\n\t"
+        "pshufb %%xmm7, %%xmm3\n\t"
+        "movdqu %%xmm3, 16(%[p])\n\t"
+        "movdqu 32(%[buf]), %%xmm3\n\t"
+        "pshufb %%xmm7, %%xmm3\n\t"
+        "movdqu %%xmm3, 32(%[p])\n\t"
+        "movdqu 48(%[buf]), %%xmm3\n\t"
+        "pshufb %%xmm7, %%xmm3\n\t"
+        "movdqu %%xmm3, 48(%[p])\n\t"
+        "movl $12, %[count]\n"
+        /* W[i..i+3] from W[i-16..i-13], W[i-12..i-9], W[i-7..i-4] and W[i-4..i-1] */
+        "1:\tmovdqu (%[p]), %%xmm3\n\t"
+        "movdqu 16(%[p]), %%xmm4\n\t"
+        "sha256msg1 %%xmm4, %%xmm3\n\t"
+        "movdqu 36(%[p]), %%xmm4\n\t"
+        "paddd %%xmm4, %%xmm3\n\t"
+        "movdqu 48(%[p]), %%xmm4\n\t"
+        "sha256msg2 %%xmm4, %%xmm3\n\t"
+        "movdqu %%xmm3, 64(%[p])\n\t"
+        "add $16, %[p]\n\t"
+        "decl %[count]\n\t"
+        "jnz 1b\n\t"
+        /* load the state as ABEF in xmm1 and CDGH in xmm2 */
+        "movdqu (%[h]), %%xmm3\n\t"
+        "movdqu 16(%[h]), %%xmm2\n\t"
+        "pshufd $0xb1, %%xmm3, %%xmm3\n\t"
+        "pshufd $0x1b, %%xmm2, %%xmm2\n\t"
+        "movdqa %%xmm3, %%xmm1\n\t"
+        "palignr $8, %%xmm2, %%xmm1\n\t"
+        "pblendw $0xf0, %%xmm3, %%xmm2\n\t"
+        "movdqa %%xmm1, %%xmm5\n\t"
+        "movdqa %%xmm2, %%xmm6\n\t"
+        "movl $16, %[count]\n"
+        "2:\tmovdqu (%[w]), %%xmm0\n\t"
+        "movdqu (%[k]), %%xmm3\n\t"
+        "paddd %%xmm3, %%xmm0\n\t"
+        "sha256rnds2 %%xmm0, %%xmm1, %%xmm2\n\t"
+        "pshufd $0x0e, %%xmm0, %%xmm0\n\t"
+        "sha256rnds2 %%xmm0, %%xmm2, %%xmm1\n\t"
+        "add $16, %[w]\n\t"
+        "add $16, %[k]\n\t"
+        "decl %[count]\n\t"
+        "jnz 2b\n\t"
+        "paddd %%xmm5, %%xmm1\n\t"
+        "paddd %%xmm6, %%xmm2\n\t"
+        /* store the state back as ABCD and EFGH */
+        "pshufd $0x1b, %%xmm1, %%xmm3\n\t"
+        "pshufd $0xb1, %%xmm2, %%xmm2\n\t"
+        "movdqa %%xmm3, %%xmm1\n\t"
+        "pblendw $0xf0, %%xmm2, %%xmm1\n\t"
+        "palignr $8, %%xmm3, %%xmm2\n\t"
+        "movdqu %%xmm1, (%[h])\n\t"
+        "movdqu %%xmm2, 16(%[h])\n\t"
+        : [p] "+r" (p), [w] "+r" (w), [k] "+r" (k), [count] "=&r" (count)
+        : [buf] "r" (buffer), [h] "r" (ctx->h), [mask] "r" (bswap_mask)
+        : "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7", "memory", "cc" );
+}
+
+#endif
+
 static void processblock(SHA256_CTX *ctx, const UCHAR *buffer)
 {
     DWORD W[64], t1, t2, a, b, c, d, e, f, g, h;
     int i;
 
+#if defined(__x86_64__) && defined(__GNUC__)
+    if (have_shani())
+    {
+        processblock_shani(ctx, buffer);
+        return;
+    }
+#endif
+
     for (i = 0; i < 16; i++)
     {
         W[i]  = (DWORD)buffer[4*i]<<24;
@@ -91,6 +195,7 @@ static void processblock(SHA256_CTX *ctx, const UCHAR *buffer)
     ctx->h[7] += h;
 }
 
+
 static void pad(SHA256_CTX *ctx)
 {
     ULONG64 r = ctx->len % 64;
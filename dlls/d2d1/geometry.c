@@ -117,6 +117,20 @@ struct d2d_geometry_intersections
     size_t intersection_count;
 };
 
+struct d2d_geometry_segment
+{
+    struct d2d_segment_idx idx;
+    D2D1_RECT_F bounds;
+    BOOL bezier;
+};
+
+struct d2d_geometry_segments
+{
+    struct d2d_geometry_segment *segments;
+    size_t segments_size;
+    size_t segment_count;
+};
+
 struct d2d_fp_two_vec2
 {
     float x[2];
@@ -1933,79 +1947,159 @@ static BOOL d2d_geometry_apply_intersections(struct d2d_geometry *geometry,
     return TRUE;
 }
 
-/* Intersect the geometry's segments with themselves. This uses the
- * straightforward approach of testing everything against everything, but
- * there certainly exist more scalable algorithms for this. */
+static int __cdecl d2d_geometry_segments_compare(const void *a, const void *b)
+{
+    const struct d2d_geometry_segment *s0 = a;
+    const struct d2d_geometry_segment *s1 = b;
+
+    if (s0->bounds.left != s1->bounds.left)
+        return s0->bounds.left > s1->bounds.left ? 1 : -1;
+    if (s0->idx.figure_idx != s1->idx.figure_idx)
+        return s0->idx.figure_idx > s1->idx.figure_idx ? 1 : -1;
+    if (s0->idx.vertex_idx != s1->idx.vertex_idx)
+        return s0->idx.vertex_idx > s1->idx.vertex_idx ? 1 : -1;
+    return 0;
+}
+
+static BOOL d2d_geometry_get_segments(struct d2d_geometry *geometry, struct d2d_geometry_segments *segments)
+{
+    struct d2d_geometry_segment *segment;
+    const struct d2d_figure *figure;
+    struct d2d_segment_idx idx;
+    size_t next;
+
+    for (idx.figure_idx = 0; idx.figure_idx < geometry->u.path.figure_count; ++idx.figure_idx)
+    {
+        figure = &geometry->u.path.figures[idx.figure_idx];
+        if (!d2d_array_reserve((void **)&segments->segments, &segments->segments_size,
+                segments->segment_count + figure->vertex_count, sizeof(*segments->segments)))
+        {
+            ERR("Failed to grow segments array.\n");
+            return FALSE;
+        }
+
+        idx.control_idx = 0;
+        for (idx.vertex_idx = 0; idx.vertex_idx < figure->vertex_count; ++idx.vertex_idx)
+        {
+            segment = &segments->segments[segments->segment_count++];
+            segment->idx = idx;
+            segment->bezier = d2d_vertex_type_is_bezier(figure->vertex_types[idx.vertex_idx]);
+
+            next = idx.vertex_idx + 1;
+            if (next == figure->vertex_count)
+                next = 0;
+
+            if (segment->bezier)
+            {
+                d2d_rect_get_bezier_bounds(&segment->bounds, &figure->vertices[idx.vertex_idx],
+                        &figure->bezier_controls[idx.control_idx], &figure->vertices[next]);
+                ++idx.control_idx;
+            }
+            else
+            {
+                segment->bounds.left = figure->vertices[idx.vertex_idx].x;
+                segment->bounds.top = figure->vertices[idx.vertex_idx].y;
+                segment->bounds.right = figure->vertices[idx.vertex_idx].x;
+                segment->bounds.bottom = figure->vertices[idx.vertex_idx].y;
+                d2d_rect_expand(&segment->bounds, &figure->vertices[next]);
+            }
+        }
+    }
+
+    return TRUE;
+}
+
+static BOOL d2d_geometry_intersect_segments(struct d2d_geometry *geometry,
+        struct d2d_geometry_intersections *intersections, const struct d2d_geometry_segment *a,
+        const struct d2d_geometry_segment *b)
+{
+    const struct d2d_geometry_segment *p, *q;
+
+    /* Keep the same argument order as a figure order walk would use. */
+    if (a->idx.figure_idx > b->idx.figure_idx
+            || (a->idx.figure_idx == b->idx.figure_idx && a->idx.vertex_idx > b->idx.vertex_idx))
+    {
+        p = a;
+        q = b;
+    }
+    else
+    {
+        p = b;
+        q = a;
+    }
+
+    if (q->bezier)
+    {
+        if (p->bezier)
+            return d2d_geometry_intersect_bezier_bezier(geometry, intersections,
+                    &p->idx, 0.0f, 1.0f, &q->idx, 0.0f, 1.0f);
+        return d2d_geometry_intersect_bezier_line(geometry, intersections, &q->idx, &p->idx);
+    }
+
+    if (p->bezier)
+        return d2d_geometry_intersect_bezier_line(geometry, intersections, &p->idx, &q->idx);
+    return d2d_geometry_intersect_line_line(geometry, intersections, &p->idx, &q->idx);
+}
+
+/* Intersect the geometry's segments with themselves. Segments are sorted on
+ * the left edge of their bounding boxes and swept from left to right; only
+ * segments whose bounding boxes overlap are tested against each other. */
 static BOOL d2d_geometry_intersect_self(struct d2d_geometry *geometry)
 {
     struct d2d_geometry_intersections intersections = {0};
-    const struct d2d_figure *figure_p, *figure_q;
-    struct d2d_segment_idx idx_p, idx_q;
-    enum d2d_vertex_type type_p, type_q;
+    struct d2d_geometry_segments segments = {0};
+    const struct d2d_geometry_segment *p, *q;
+    size_t *active = NULL, active_count = 0;
+    size_t i, j, k;
     BOOL ret = FALSE;
-    size_t max_q;
 
     if (!geometry->u.path.figure_count)
         return TRUE;
 
-    for (idx_p.figure_idx = 0; idx_p.figure_idx < geometry->u.path.figure_count; ++idx_p.figure_idx)
+    if (!d2d_geometry_get_segments(geometry, &segments))
+        goto done;
+    if (!segments.segment_count)
+    {
+        ret = TRUE;
+        goto done;
+    }
+
+    if (!(active = heap_calloc(segments.segment_count, sizeof(*active))))
+    {
+        ERR("Failed to allocate active segments array.\n");
+        goto done;
+    }
+
+    qsort(segments.segments, segments.segment_count, sizeof(*segments.segments), d2d_geometry_segments_compare);
+
+    for (i = 0; i < segments.segment_count; ++i)
     {
-        figure_p = &geometry->u.path.figures[idx_p.figure_idx];
-        idx_p.control_idx = 0;
-        for (idx_p.vertex_idx = 0; idx_p.vertex_idx < figure_p->vertex_count; ++idx_p.vertex_idx)
+        p = &segments.segments[i];
+
+        for (j = 0, k = 0; j < active_count; ++j)
         {
-            type_p = figure_p->vertex_types[idx_p.vertex_idx];
-            for (idx_q.figure_idx = 0; idx_q.figure_idx <= idx_p.figure_idx; ++idx_q.figure_idx)
-            {
-                figure_q = &geometry->u.path.figures[idx_q.figure_idx];
-                if (idx_q.figure_idx != idx_p.figure_idx)
-                {
-                    if (!d2d_rect_check_overlap(&figure_p->bounds, &figure_q->bounds))
-                        continue;
-                    max_q = figure_q->vertex_count;
-                }
-                else
-                {
-                    max_q = idx_p.vertex_idx;
-                }
+            q = &segments.segments[active[j]];
 
-                idx_q.control_idx = 0;
-                for (idx_q.vertex_idx = 0; idx_q.vertex_idx < max_q; ++idx_q.vertex_idx)
-                {
-                    type_q = figure_q->vertex_types[idx_q.vertex_idx];
-                    if (d2d_vertex_type_is_bezier(type_q))
-                    {
-                        if (d2d_vertex_type_is_bezier(type_p))
-                        {
-                            if (!d2d_geometry_intersect_bezier_bezier(geometry, &intersections,
-                                    &idx_p, 0.0f, 1.0f, &idx_q, 0.0f, 1.0f))
-                                goto done;
-                        }
-                        else
-                        {
-                            if (!d2d_geometry_intersect_bezier_line(geometry, &intersections, &idx_q, &idx_p))
-                                goto done;
-                        }
-                        ++idx_q.control_idx;
-                    }
-                    else
-                    {
-                        if (d2d_vertex_type_is_bezier(type_p))
-                        {
-                            if (!d2d_geometry_intersect_bezier_line(geometry, &intersections, &idx_p, &idx_q))
-                                goto done;
-                        }
-                        else
-                        {
-                            if (!d2d_geometry_intersect_line_line(geometry, &intersections, &idx_p, &idx_q))
-                                goto done;
-                        }
-                    }
-                }
-            }
-            if (d2d_vertex_type_is_bezier(type_p))
-                ++idx_p.control_idx;
+            /* Segments are sorted on their left edge, so anything that ends
+             * before this segment starts can't intersect any later segment
+             * either. */
+            if (q->bounds.right < p->bounds.left)
+                continue;
+            active[k++] = active[j];
+
+            if (q->bounds.bottom < p->bounds.top || q->bounds.top > p->bounds.bottom)
+                continue;
+            if (q->idx.figure_idx != p->idx.figure_idx
+                    && !d2d_rect_check_overlap(&geometry->u.path.figures[p->idx.figure_idx].bounds,
+                    &geometry->u.path.figures[q->idx.figure_idx].bounds))
+                continue;
+
+            if (!d2d_geometry_intersect_segments(geometry, &intersections, p, q))
+                goto done;
         }
+
+        active_count = k;
+        active[active_count++] = i;
     }
 
     qsort(intersections.intersections, intersections.intersection_count,
@@ -2013,6 +2107,8 @@ static BOOL d2d_geometry_intersect_self(struct d2d_geometry *geometry)
     ret = d2d_geometry_apply_intersections(geometry, &intersections);
 
 done:
+    heap_free(active);
+    heap_free(segments.segments);
     heap_free(intersections.intersections);
     return ret;
 }
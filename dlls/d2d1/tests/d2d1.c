@@ -7912,6 +7912,174 @@ static void test_bezier_intersect(void)
     DestroyWindow(window);
 }
 
+static ID2D1PathGeometry *create_saw_tooth_geometry(ID2D1Factory *factory, unsigned int tooth_count)
+{
+    ID2D1PathGeometry *geometry;
+    ID2D1GeometrySink *sink;
+    D2D1_POINT_2F point;
+    unsigned int i;
+    HRESULT hr;
+
+    hr = ID2D1Factory_CreatePathGeometry(factory, &geometry);
+    ok(SUCCEEDED(hr), "Failed to create path geometry, hr %#x.\n", hr);
+    hr = ID2D1PathGeometry_Open(geometry, &sink);
+    ok(SUCCEEDED(hr), "Failed to open geometry sink, hr %#x.\n", hr);
+
+    /* A saw tooth crossed by a horizontal strip; every tooth edge intersects
+     * both long edges of the strip. */
+    set_point(&point, 0.0f, 0.0f);
+    ID2D1GeometrySink_BeginFigure(sink, point, D2D1_FIGURE_BEGIN_FILLED);
+    for (i = 1; i <= 2 * tooth_count; ++i)
+        line_to(sink, 2.0f * i, i & 1 ? 10.0f : 0.0f);
+    ID2D1GeometrySink_EndFigure(sink, D2D1_FIGURE_END_CLOSED);
+
+    set_point(&point, -1.0f, 4.0f);
+    ID2D1GeometrySink_BeginFigure(sink, point, D2D1_FIGURE_BEGIN_FILLED);
+    line_to(sink, 4.0f * tooth_count + 1.0f, 4.0f);
+    line_to(sink, 4.0f * tooth_count + 1.0f, 6.0f);
+    line_to(sink, -1.0f, 6.0f);
+    ID2D1GeometrySink_EndFigure(sink, D2D1_FIGURE_END_CLOSED);
+
+    hr = ID2D1GeometrySink_Close(sink);
+    ok(SUCCEEDED(hr), "Failed to close geometry sink, hr %#x.\n", hr);
+    ID2D1GeometrySink_Release(sink);
+
+    return geometry;
+}
+
+static void test_large_path_geometry(void)
+{
+    static const unsigned int tooth_count = 1000;
+    ID2D1SolidColorBrush *brush;
+    struct resource_readback rb;
+    ID2D1PathGeometry *geometry;
+    D2D1_MATRIX_3X2_F matrix;
+    IDXGISwapChain *swapchain;
+    ID2D1RenderTarget *rt;
+    ID3D10Device1 *device;
+    IDXGISurface *surface;
+    ID2D1Factory *factory;
+    D2D1_POINT_2F point;
+    D2D1_COLOR_F colour;
+    unsigned int i, j;
+    BOOL contains;
+    UINT32 count;
+    HWND window;
+    HRESULT hr;
+
+    /* The fill alternates between the inside of a tooth and the inside of the
+     * strip, so a missed or misplaced intersection shows up in the fill. */
+    static const struct
+    {
+        float x, y;
+        BOOL filled;
+    }
+    fill_tests[] =
+    {
+        {-0.5f, 5.0f, TRUE}, {0.7f, 5.0f, TRUE}, {1.3f, 5.0f, FALSE}, {2.0f, 5.0f, FALSE},
+        { 2.0f, 8.0f, TRUE}, {2.0f, 2.0f, TRUE}, {2.0f, 10.5f, FALSE}, {4.0f, 5.0f, TRUE},
+        { 4.0f, 2.0f, FALSE}, {4.0f, 8.0f, FALSE}, {6.0f, 5.0f, FALSE}, {9.5f, 5.0f, FALSE},
+        {10.7f, 5.0f, FALSE}, {11.3f, 5.0f, TRUE}, {12.5f, 5.0f, TRUE},
+    };
+
+    hr = D2D1CreateFactory(D2D1_FACTORY_TYPE_SINGLE_THREADED, &IID_ID2D1Factory, NULL, (void **)&factory);
+    ok(SUCCEEDED(hr), "Failed to create factory, hr %#x.\n", hr);
+
+    geometry = create_saw_tooth_geometry(factory, tooth_count);
+
+    hr = ID2D1PathGeometry_GetFigureCount(geometry, &count);
+    ok(SUCCEEDED(hr), "Failed to get figure count, hr %#x.\n", hr);
+    ok(count == 2, "Got unexpected figure count %u.\n", count);
+
+    set_point(&point, 2.0f, 8.0f);
+    hr = ID2D1PathGeometry_FillContainsPoint(geometry, point, NULL, 0.0f, &contains);
+    ok(SUCCEEDED(hr), "Failed to check if geometry contains point, hr %#x.\n", hr);
+    ok(contains, "Got unexpected contains %#x.\n", contains);
+
+    set_point(&point, 2.0f, 5.0f);
+    hr = ID2D1PathGeometry_FillContainsPoint(geometry, point, NULL, 0.0f, &contains);
+    ok(SUCCEEDED(hr), "Failed to check if geometry contains point, hr %#x.\n", hr);
+    ok(!contains, "Got unexpected contains %#x.\n", contains);
+
+    set_point(&point, 4.0f, 5.0f);
+    hr = ID2D1PathGeometry_FillContainsPoint(geometry, point, NULL, 0.0f, &contains);
+    ok(SUCCEEDED(hr), "Failed to check if geometry contains point, hr %#x.\n", hr);
+    ok(contains, "Got unexpected contains %#x.\n", contains);
+
+    set_point(&point, 4.0f, 8.0f);
+    hr = ID2D1PathGeometry_FillContainsPoint(geometry, point, NULL, 0.0f, &contains);
+    ok(SUCCEEDED(hr), "Failed to check if geometry contains point, hr %#x.\n", hr);
+    ok(!contains, "Got unexpected contains %#x.\n", contains);
+
+    set_point(&point, 4.0f * tooth_count - 2.0f, 8.0f);
+    hr = ID2D1PathGeometry_FillContainsPoint(geometry, point, NULL, 0.0f, &contains);
+    ok(SUCCEEDED(hr), "Failed to check if geometry contains point, hr %#x.\n", hr);
+    ok(contains, "Got unexpected contains %#x.\n", contains);
+
+    ID2D1PathGeometry_Release(geometry);
+    ID2D1Factory_Release(factory);
+
+    if (!(device = create_device()))
+    {
+        skip("Failed to create device, skipping tests.\n");
+        return;
+    }
+    window = create_window();
+    swapchain = create_swapchain(device, window, TRUE);
+    hr = IDXGISwapChain_GetBuffer(swapchain, 0, &IID_IDXGISurface, (void **)&surface);
+    ok(SUCCEEDED(hr), "Failed to get buffer, hr %#x.\n", hr);
+    rt = create_render_target(surface);
+    ok(!!rt, "Failed to create render target.\n");
+    ID2D1RenderTarget_GetFactory(rt, &factory);
+
+    ID2D1RenderTarget_SetDpi(rt, 96.0f, 96.0f);
+    ID2D1RenderTarget_SetAntialiasMode(rt, D2D1_ANTIALIAS_MODE_ALIASED);
+    set_color(&colour, 0.0f, 0.0f, 1.0f, 1.0f);
+    hr = ID2D1RenderTarget_CreateSolidColorBrush(rt, &colour, NULL, &brush);
+    ok(SUCCEEDED(hr), "Failed to create brush, hr %#x.\n", hr);
+
+    geometry = create_saw_tooth_geometry(factory, tooth_count);
+
+    /* Draw the first three teeth, and then the last three, 40 times larger. */
+    for (i = 0; i < 2; ++i)
+    {
+        float offset = i ? 4.0f * (tooth_count - 3) : 0.0f;
+
+        set_matrix_identity(&matrix);
+        scale_matrix(&matrix, 40.0f, 40.0f);
+        translate_matrix(&matrix, 1.0f - offset, 1.0f);
+
+        ID2D1RenderTarget_BeginDraw(rt);
+        set_color(&colour, 1.0f, 1.0f, 1.0f, 1.0f);
+        ID2D1RenderTarget_Clear(rt, &colour);
+        ID2D1RenderTarget_SetTransform(rt, &matrix);
+        ID2D1RenderTarget_FillGeometry(rt, (ID2D1Geometry *)geometry, (ID2D1Brush *)brush, NULL);
+        hr = ID2D1RenderTarget_EndDraw(rt, NULL, NULL);
+        ok(SUCCEEDED(hr), "Failed to end draw, hr %#x.\n", hr);
+
+        get_surface_readback(surface, &rb);
+        for (j = 0; j < ARRAY_SIZE(fill_tests); ++j)
+        {
+            unsigned int x = (fill_tests[j].x + 1.0f) * 40.0f, y = (fill_tests[j].y + 1.0f) * 40.0f;
+            DWORD expected = fill_tests[j].filled ? 0xff0000ff : 0xffffffff, colour;
+
+            colour = get_readback_colour(&rb, x, y);
+            ok(compare_colour(colour, expected, 0),
+                    "Got unexpected colour 0x%08x at position {%u, %u}, view %u.\n", colour, x, y, i);
+        }
+        release_resource_readback(&rb);
+    }
+
+    ID2D1PathGeometry_Release(geometry);
+    ID2D1SolidColorBrush_Release(brush);
+    ID2D1RenderTarget_Release(rt);
+    ID2D1Factory_Release(factory);
+    IDXGISurface_Release(surface);
+    IDXGISwapChain_Release(swapchain);
+    ID3D10Device1_Release(device);
+    DestroyWindow(window);
+}
+
 static void test_create_device(void)
 {
     D2D1_CREATION_PROPERTIES properties = {0};
@@ -9471,6 +9639,7 @@ START_TEST(d2d1)
     queue_test(test_gdi_interop);
     queue_test(test_layer);
     queue_test(test_bezier_intersect);
+    queue_test(test_large_path_geometry);
     queue_test(test_create_device);
     queue_test(test_bitmap_surface);
     queue_test(test_device_context);
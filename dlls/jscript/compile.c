@@ -232,6 +232,7 @@ static unsigned push_instr(compiler_ctx_t *ctx, jsop_t op)
 
     ctx->code->instrs[ctx->code_off].op = op;
     ctx->code->instrs[ctx->code_off].loc = ctx->loc;
+    memset(&ctx->code->instrs[ctx->code_off].u, 0, sizeof(ctx->code->instrs[ctx->code_off].u));
     return ctx->code_off++;
 }
 
@@ -360,8 +361,47 @@ static HRESULT push_instr_uint(compiler_ctx_t *ctx, jsop_t op, unsigned arg)
     return S_OK;
 }
 
+/* Replaces arithmetic on two numeric constants, emitted as the last two instructions, by its result. */
+static BOOL fold_binary_constants(compiler_ctx_t *ctx, unsigned off, jsop_t op)
+{
+    instr_t *left, *right;
+
+    if(ctx->code_off != off + 2)
+        return FALSE;
+
+    left = instr_ptr(ctx, off);
+    right = instr_ptr(ctx, off + 1);
+    if(left->op != OP_double || right->op != OP_double)
+        return FALSE;
+
+    switch(op) {
+    case OP_add:
+        left->u.dbl += right->u.dbl;
+        break;
+    case OP_sub:
+        left->u.dbl -= right->u.dbl;
+        break;
+    case OP_mul:
+        left->u.dbl *= right->u.dbl;
+        break;
+    case OP_div:
+        left->u.dbl /= right->u.dbl;
+        break;
+    case OP_mod:
+        left->u.dbl = fmod(left->u.dbl, right->u.dbl);
+        break;
+    default:
+        return FALSE;
+    }
+
+    TRACE("folded to %lf\n", left->u.dbl);
+    ctx->code_off--;
+    return TRUE;
+}
+
 static HRESULT compile_binary_expression(compiler_ctx_t *ctx, binary_expression_t *expr, jsop_t op)
 {
+    unsigned off = ctx->code_off;
     HRESULT hres;
 
     hres = compile_expression(ctx, expr->expression1, TRUE);
@@ -372,17 +412,31 @@ static HRESULT compile_binary_expression(compiler_ctx_t *ctx, binary_expression_
     if(FAILED(hres))
         return hres;
 
+    if(fold_binary_constants(ctx, off, op))
+        return S_OK;
+
     return push_instr(ctx, op) ? S_OK : E_OUTOFMEMORY;
 }
 
 static HRESULT compile_unary_expression(compiler_ctx_t *ctx, unary_expression_t *expr, jsop_t op)
 {
+    unsigned off = ctx->code_off;
     HRESULT hres;
 
     hres = compile_expression(ctx, expr->expression, TRUE);
     if(FAILED(hres))
         return hres;
 
+    /* Numeric constants don't need to be converted or negated at run time. */
+    if(ctx->code_off == off + 1 && instr_ptr(ctx, off)->op == OP_double) {
+        if(op == OP_tonum)
+            return S_OK;
+        if(op == OP_minus) {
+            instr_ptr(ctx, off)->u.dbl = -instr_ptr(ctx, off)->u.dbl;
+            return S_OK;
+        }
+    }
+
     return push_instr(ctx, op) ? S_OK : E_OUTOFMEMORY;
 }
 
@@ -1221,6 +1275,32 @@ static HRESULT compile_if_statement(compiler_ctx_t *ctx, if_statement_t *stat)
     return S_OK;
 }
 
+static BOOL is_true_literal(expression_t *expr)
+{
+    literal_t *literal;
+
+    if(expr->type != EXPR_LITERAL)
+        return FALSE;
+
+    literal = ((literal_expression_t*)expr)->literal;
+    return literal->type == LT_BOOL && literal->u.bval;
+}
+
+static HRESULT compile_loop_condition(compiler_ctx_t *ctx, expression_t *expr, unsigned break_label)
+{
+    HRESULT hres;
+
+    /* A constant true condition doesn't need to be evaluated. */
+    if(is_true_literal(expr))
+        return S_OK;
+
+    hres = compile_expression(ctx, expr, TRUE);
+    if(FAILED(hres))
+        return hres;
+
+    return push_instr_uint(ctx, OP_jmp_z, break_label);
+}
+
 /* ECMA-262 3rd Edition    12.6.2 */
 static HRESULT compile_while_statement(compiler_ctx_t *ctx, while_statement_t *stat)
 {
@@ -1240,11 +1320,7 @@ static HRESULT compile_while_statement(compiler_ctx_t *ctx, while_statement_t *s
 
     if(!stat->do_while) {
         label_set_addr(ctx, stat_ctx.continue_label);
-        hres = compile_expression(ctx, stat->expr, TRUE);
-        if(FAILED(hres))
-            return hres;
-
-        hres = push_instr_uint(ctx, OP_jmp_z, stat_ctx.break_label);
+        hres = compile_loop_condition(ctx, stat->expr, stat_ctx.break_label);
         if(FAILED(hres))
             return hres;
     }
@@ -1256,11 +1332,7 @@ static HRESULT compile_while_statement(compiler_ctx_t *ctx, while_statement_t *s
     set_compiler_loc(ctx, stat->stat.loc);
     if(stat->do_while) {
         label_set_addr(ctx, stat_ctx.continue_label);
-        hres = compile_expression(ctx, stat->expr, TRUE);
-        if(FAILED(hres))
-            return hres;
-
-        hres = push_instr_uint(ctx, OP_jmp_z, stat_ctx.break_label);
+        hres = compile_loop_condition(ctx, stat->expr, stat_ctx.break_label);
         if(FAILED(hres))
             return hres;
     }
@@ -1302,11 +1374,7 @@ static HRESULT compile_for_statement(compiler_ctx_t *ctx, for_statement_t *stat)
 
     if(stat->expr) {
         set_compiler_loc(ctx, stat->expr_loc);
-        hres = compile_expression(ctx, stat->expr, TRUE);
-        if(FAILED(hres))
-            return hres;
-
-        hres = push_instr_uint(ctx, OP_jmp_z, stat_ctx.break_label);
+        hres = compile_loop_condition(ctx, stat->expr, stat_ctx.break_label);
         if(FAILED(hres))
             return hres;
     }
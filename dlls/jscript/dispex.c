@@ -1895,6 +1895,31 @@ HRESULT jsdisp_get_id(jsdisp_t *jsdisp, const WCHAR *name, DWORD flags, DISPID *
     return DISP_E_UNKNOWNNAME;
 }
 
+/*
+ * Same as jsdisp_get_id, but first tries the id stored in *cache by an earlier
+ * lookup of the same name. Objects created the same way get their properties
+ * allocated in the same order, so the id is usually still valid even for a
+ * different object, and the hash lookup and prototype chain walk can be skipped.
+ */
+HRESULT jsdisp_get_id_cached(jsdisp_t *jsdisp, const WCHAR *name, DWORD flags, unsigned *cache, DISPID *id)
+{
+    dispex_prop_t *prop;
+    HRESULT hres;
+
+    if(*cache && *cache < jsdisp->prop_cnt) {
+        prop = jsdisp->props + *cache;
+        if(prop->type != PROP_DELETED && !wcscmp(prop->name, name)) {
+            *id = *cache;
+            return S_OK;
+        }
+    }
+
+    hres = jsdisp_get_id(jsdisp, name, flags, id);
+    if(SUCCEEDED(hres))
+        *cache = *id;
+    return hres;
+}
+
 HRESULT jsdisp_call_value(jsdisp_t *jsfunc, IDispatch *jsthis, WORD flags, unsigned argc, jsval_t *argv, jsval_t *r)
 {
     HRESULT hres;
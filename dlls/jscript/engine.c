@@ -454,6 +454,21 @@ static HRESULT disp_get_id(script_ctx_t *ctx, IDispatch *disp, const WCHAR *name
     return hres;
 }
 
+static HRESULT disp_get_id_cached(script_ctx_t *ctx, IDispatch *disp, const WCHAR *name, BSTR name_bstr,
+        DWORD flags, unsigned *cache, DISPID *id)
+{
+    jsdisp_t *jsdisp;
+    HRESULT hres;
+
+    jsdisp = iface_to_jsdisp(disp);
+    if(!jsdisp)
+        return disp_get_id(ctx, disp, name, name_bstr, flags, id);
+
+    hres = jsdisp_get_id_cached(jsdisp, name, flags, cache, id);
+    jsdisp_release(jsdisp);
+    return hres;
+}
+
 static HRESULT disp_cmp(IDispatch *disp1, IDispatch *disp2, BOOL *ret)
 {
     IObjectIdentity *identity;
@@ -719,6 +734,13 @@ static inline jsstr_t *get_op_str(script_ctx_t *ctx, int i)
     return frame->bytecode->instrs[frame->ip].u.arg[i].str;
 }
 
+/* Property id cache of OP_member and OP_memberid, see jsdisp_get_id_cached. */
+static inline unsigned *get_op_id_cache(script_ctx_t *ctx)
+{
+    call_frame_t *frame = ctx->call_ctx;
+    return &frame->bytecode->instrs[frame->ip].u.arg[1].uint;
+}
+
 static inline double get_op_double(script_ctx_t *ctx)
 {
     call_frame_t *frame = ctx->call_ctx;
@@ -1093,7 +1115,7 @@ static HRESULT interp_member(script_ctx_t *ctx)
     if(FAILED(hres))
         return hres;
 
-    hres = disp_get_id(ctx, obj, arg, arg, 0, &id);
+    hres = disp_get_id_cached(ctx, obj, arg, arg, 0, get_op_id_cache(ctx), &id);
     if(SUCCEEDED(hres)) {
         hres = disp_propget(ctx, obj, id, &v);
     }else if(hres == DISP_E_UNKNOWNNAME) {
@@ -1135,7 +1157,7 @@ static HRESULT interp_memberid(script_ctx_t *ctx)
     if(FAILED(hres))
         return hres;
 
-    hres = disp_get_id(ctx, obj, name, NULL, arg, &id);
+    hres = disp_get_id_cached(ctx, obj, name, NULL, arg, get_op_id_cache(ctx), &id);
     jsstr_release(name_str);
     if(SUCCEEDED(hres)) {
         ref.type = EXPRVAL_IDREF;
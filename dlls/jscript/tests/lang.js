@@ -1916,6 +1916,78 @@ ok(Date === 1, "Date = " + Date);
 Error = 1;
 ok(Error === 1, "Error = " + Error);
 
+function testMemberLookup() {
+    var objs = [], i, r = "";
+
+    function getX(o) { return o.x; }
+    function setX(o, v) { o["x"] = v; }
+    function C() {}
+    C.prototype.x = 8;
+
+    objs.push({x: 1, y: 2});
+    objs.push({y: 3, x: 4});
+    objs.push({x: 5, y: 6});
+    objs.push({y: 7});
+    objs.push(new C());
+    objs.push({x: 9});
+    delete objs[5].x;
+    objs.push({z: 0, x: 10});
+
+    for(i = 0; i < objs.length; i++)
+        r += getX(objs[i]) + ",";
+    ok(r === "1,4,5,undefined,8,undefined,10,", "r = " + r);
+
+    for(i = 0; i < objs.length; i++)
+        setX(objs[i], i);
+    r = "";
+    for(i = 0; i < objs.length; i++)
+        r += getX(objs[i]) + ",";
+    ok(r === "0,1,2,3,4,5,6,", "r = " + r);
+
+    objs[0].x = 100;
+    delete objs[0].x;
+    ok(getX(objs[0]) === undefined, "getX(objs[0]) = " + getX(objs[0]));
+    objs[0].x = 101;
+    ok(getX(objs[0]) === 101, "getX(objs[0]) = " + getX(objs[0]));
+}
+testMemberLookup();
+
+/* Expressions on constants are evaluated by the compiler. */
+tmp = 2;
+ok(1 + 2 * 3 === 7, "1 + 2 * 3 = " + (1 + 2 * 3));
+ok(1 + tmp * 3 === 7, "1 + tmp * 3 = " + (1 + tmp * 3));
+ok((7 - 2) / 2 === 2.5, "(7 - 2) / 2 = " + ((7 - 2) / 2));
+ok(-(2 - 3) === 1, "-(2 - 3) = " + (-(2 - 3)));
+ok(+(2 - 3) === -1, "+(2 - 3) = " + (+(2 - 3)));
+ok(7 % 3 === 1, "7 % 3 = " + (7 % 3));
+ok(-7 % 3 === -1, "-7 % 3 = " + (-7 % 3));
+ok(1 / 0 === Infinity, "1 / 0 = " + (1 / 0));
+ok(1 / -0 === -Infinity, "1 / -0 = " + (1 / -0));
+ok(isNaN(0 / 0), "0 / 0 = " + (0 / 0));
+ok("1" + 2 === "12", "\"1\" + 2 = " + ("1" + 2));
+ok(1 + 2 + "3" === "33", "1 + 2 + \"3\" = " + (1 + 2 + "3"));
+ok(typeof(-1) === "number", "typeof(-1) = " + typeof(-1));
+
+tmp = 0;
+while(true) {
+    if(++tmp == 3)
+        break;
+}
+ok(tmp === 3, "tmp = " + tmp);
+
+tmp = 0;
+do {
+    if(++tmp == 3)
+        break;
+}while(true);
+ok(tmp === 3, "tmp = " + tmp);
+
+for(tmp = 0; true; tmp++) {
+    if(tmp == 3)
+        break;
+}
+ok(tmp === 3, "tmp = " + tmp);
+
 /* Keep this test in the end of file */
 undefined = 6;
 ok(undefined === 6, "undefined = " + undefined);
@@ -497,10 +497,11 @@ BOOL WINAPI DECLSPEC_HOTPATCH AreFileApisANSI(void)
 BOOL WINAPI CopyFileExW( const WCHAR *source, const WCHAR *dest, LPPROGRESS_ROUTINE progress,
                          void *param, BOOL *cancel_ptr, DWORD flags )
 {
-    static const int buffer_size = 65536;
+    static const int buffer_size = 0x100000;
     HANDLE h1, h2;
     BY_HANDLE_FILE_INFORMATION info;
-    DWORD count;
+    LARGE_INTEGER size, transferred;
+    DWORD count, action, access = GENERIC_WRITE;
     BOOL ret = FALSE;
     char *buffer;
 
@@ -551,9 +552,18 @@ BOOL WINAPI CopyFileExW( const WCHAR *source, const WCHAR *dest, LPPROGRESS_ROUT
         }
     }
 
-    if ((h2 = CreateFileW( dest, GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
-                           (flags & COPY_FILE_FAIL_IF_EXISTS) ? CREATE_NEW : CREATE_ALWAYS,
-                           info.dwFileAttributes, h1 )) == INVALID_HANDLE_VALUE)
+    /* a cancelled copy deletes the destination file, if nobody else prevents it */
+    if (progress || cancel_ptr) access |= DELETE;
+
+    h2 = CreateFileW( dest, access, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                      (flags & COPY_FILE_FAIL_IF_EXISTS) ? CREATE_NEW : CREATE_ALWAYS,
+                      info.dwFileAttributes, h1 );
+    if (h2 == INVALID_HANDLE_VALUE && (access & DELETE) &&
+        (GetLastError() == ERROR_SHARING_VIOLATION || GetLastError() == ERROR_ACCESS_DENIED))
+        h2 = CreateFileW( dest, GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                          (flags & COPY_FILE_FAIL_IF_EXISTS) ? CREATE_NEW : CREATE_ALWAYS,
+                          info.dwFileAttributes, h1 );
+    if (h2 == INVALID_HANDLE_VALUE)
     {
         WARN("Unable to open dest %s\n", debugstr_w(dest));
         HeapFree( GetProcessHeap(), 0, buffer );
@@ -561,9 +571,31 @@ BOOL WINAPI CopyFileExW( const WCHAR *source, const WCHAR *dest, LPPROGRESS_ROUT
         return FALSE;
     }
 
-    while (ReadFile( h1, buffer, buffer_size, &count, NULL ) && count)
+    size.u.LowPart = info.nFileSizeLow;
+    size.u.HighPart = info.nFileSizeHigh;
+    transferred.QuadPart = 0;
+
+    if (flags & COPY_FILE_RESTARTABLE) FIXME( "COPY_FILE_RESTARTABLE not supported\n" );
+
+    action = progress ? progress( size, transferred, size, transferred, 1,
+                                  CALLBACK_STREAM_SWITCH, h1, h2, param ) : PROGRESS_QUIET;
+
+    while (action == PROGRESS_CONTINUE || action == PROGRESS_QUIET)
     {
         char *p = buffer;
+
+        if (cancel_ptr && *cancel_ptr)
+        {
+            action = PROGRESS_CANCEL;
+            break;
+        }
+        if (!ReadFile( h1, buffer, buffer_size, &count, NULL ) || !count)
+        {
+            ret = TRUE;
+            break;
+        }
+
+        transferred.QuadPart += count;
         while (count != 0)
         {
             DWORD res;
@@ -571,14 +603,30 @@ BOOL WINAPI CopyFileExW( const WCHAR *source, const WCHAR *dest, LPPROGRESS_ROUT
             p += res;
             count -= res;
         }
+
+        if (action == PROGRESS_CONTINUE)
+            action = progress( size, transferred, size, transferred, 1,
+                               CALLBACK_CHUNK_FINISHED, h1, h2, param );
+    }
+
+    if (action == PROGRESS_CANCEL)
+    {
+        FILE_DISPOSITION_INFO disp = { TRUE };
+        SetFileInformationByHandle( h2, FileDispositionInfo, &disp, sizeof(disp) );
     }
-    ret =  TRUE;
 done:
     /* Maintain the timestamp of source file to destination file */
     SetFileTime( h2, NULL, NULL, &info.ftLastWriteTime );
     HeapFree( GetProcessHeap(), 0, buffer );
     CloseHandle( h1 );
     CloseHandle( h2 );
+    if (!ret && (action == PROGRESS_CANCEL || action == PROGRESS_STOP))
+        SetLastError( ERROR_REQUEST_ABORTED );
+    else if (!ret && action != PROGRESS_CONTINUE && action != PROGRESS_QUIET)
+    {
+        WARN("unknown progress action %u\n", action);
+        SetLastError( ERROR_INVALID_PARAMETER );
+    }
     return ret;
 }
 
@@ -576,6 +576,15 @@ static unsigned int nb_codepages;
 
 static struct norm_table *norm_info;
 
+/* flat copy of the collation elements of the first 256 characters */
+static unsigned int latin1_collation[0x100];
+
+static inline unsigned int get_collation( WCHAR ch )
+{
+    if (ch < 0x100) return latin1_collation[ch];
+    return collation_table[collation_table[collation_table[ch >> 8] + ((ch >> 4) & 0x0f)] + (ch & 0xf)];
+}
+
 struct sortguid
 {
     GUID  id;          /* sort GUID */
@@ -724,6 +733,9 @@ void init_locale(void)
     NtGetNlsSectionPtr( 12, NormalizationC, NULL, (void **)&norm_info, &size );
     init_sortkeys( sort_ptr );
 
+    for (i = 0; i < ARRAY_SIZE(latin1_collation); i++)
+        latin1_collation[i] = collation_table[collation_table[collation_table[0] + (i >> 4)] + (i & 0xf)];
+
     if (!ansi_cp || NtGetNlsSectionPtr( 11, ansi_cp, NULL, (void **)&ansi_ptr, &size ))
         NtGetNlsSectionPtr( 11, 1252, NULL, (void **)&ansi_ptr, &size );
     if (!oem_cp || NtGetNlsSectionPtr( 11, oem_cp, 0, (void **)&oem_ptr, &size ))
@@ -2153,7 +2165,7 @@ static int get_sortkey( DWORD flags, const WCHAR *src, int srclen, char *dst, in
 
                 if (flags & NORM_IGNORECASE) wch = casemap( nls_info.LowerCaseTable, wch );
 
-                ce = collation_table[collation_table[collation_table[wch >> 8] + ((wch >> 4) & 0x0f)] + (wch & 0xf)];
+                ce = get_collation( wch );
                 if (ce != (unsigned int)-1)
                 {
                     if (ce >> 16) key_len[0] += 2;
@@ -2207,7 +2219,7 @@ static int get_sortkey( DWORD flags, const WCHAR *src, int srclen, char *dst, in
 
                 if (flags & NORM_IGNORECASE) wch = casemap( nls_info.LowerCaseTable, wch );
 
-                ce = collation_table[collation_table[collation_table[wch >> 8] + ((wch >> 4) & 0x0f)] + (wch & 0xf)];
+                ce = get_collation( wch );
                 if (ce != (unsigned int)-1)
                 {
                     WCHAR key;
@@ -2466,7 +2478,7 @@ static unsigned int get_weight( WCHAR ch, enum weight type )
 {
     unsigned int ret;
 
-    ret = collation_table[collation_table[collation_table[ch >> 8] + ((ch >> 4) & 0x0f)] + (ch & 0xf)];
+    ret = get_collation( ch );
     if (ret == ~0u) return ch;
 
     switch (type)
@@ -2575,6 +2587,56 @@ static int compare_weights(int flags, const WCHAR *str1, int len1,
 }
 
 
+static inline BOOL is_simple_ascii( WCHAR ch, unsigned int ce )
+{
+    return ch < 0x80 && ch != '-' && ch != '\'' &&
+           ce != ~0u && (ce >> 16) && (ce & 0xff00) && (ce & 0xf0);
+}
+
+/* Single pass comparison of strings made only of ASCII characters that have
+ * all three weights and no special handling. Returns FALSE if the full
+ * algorithm is needed. */
+static BOOL compare_ascii_weights( DWORD flags, const WCHAR *str1, int len1,
+                                   const WCHAR *str2, int len2, int *ret )
+{
+    int i, len = min( len1, len2 ), diacritic = 0, case_weight = 0;
+    unsigned int ce1, ce2;
+
+    if (flags & NORM_IGNORESYMBOLS) return FALSE;
+
+    for (i = 0; i < len; i++)
+    {
+        if (str1[i] == str2[i])
+        {
+            ce1 = get_collation( str1[i] );
+            if (!is_simple_ascii( str1[i], ce1 )) return FALSE;
+            continue;
+        }
+        ce1 = get_collation( str1[i] );
+        ce2 = get_collation( str2[i] );
+        if (!is_simple_ascii( str1[i], ce1 ) || !is_simple_ascii( str2[i], ce2 )) return FALSE;
+
+        if ((ce1 >> 16) != (ce2 >> 16))
+        {
+            *ret = (int)(ce1 >> 16) - (int)(ce2 >> 16);
+            return TRUE;
+        }
+        if (!diacritic) diacritic = (int)((ce1 >> 8) & 0xff) - (int)((ce2 >> 8) & 0xff);
+        if (!case_weight) case_weight = (int)((ce1 >> 4) & 0x0f) - (int)((ce2 >> 4) & 0x0f);
+    }
+
+    for (; i < len1; i++)
+        if (!is_simple_ascii( str1[i], get_collation( str1[i] ) )) return FALSE;
+    for (; i < len2; i++)
+        if (!is_simple_ascii( str2[i], get_collation( str2[i] ) )) return FALSE;
+
+    *ret = len1 - len2;
+    if (!*ret && !(flags & NORM_IGNORENONSPACE)) *ret = diacritic;
+    if (!*ret && !(flags & NORM_IGNORECASE)) *ret = case_weight;
+    return TRUE;
+}
+
+
 static const struct geoinfo *get_geoinfo_ptr( GEOID geoid )
 {
     int min = 0, max = ARRAY_SIZE( geoinfodata )-1;
@@ -3048,13 +3110,16 @@ INT WINAPI CompareStringEx( const WCHAR *locale, DWORD flags, const WCHAR *str1,
     if (len1 < 0) len1 = lstrlenW(str1);
     if (len2 < 0) len2 = lstrlenW(str2);
 
-    ret = compare_weights( flags, str1, len1, str2, len2, UNICODE_WEIGHT );
-    if (!ret)
+    if (!compare_ascii_weights( flags, str1, len1, str2, len2, &ret ))
     {
-        if (!(flags & NORM_IGNORENONSPACE))
-            ret = compare_weights( flags, str1, len1, str2, len2, DIACRITIC_WEIGHT );
-        if (!ret && !(flags & NORM_IGNORECASE))
-            ret = compare_weights( flags, str1, len1, str2, len2, CASE_WEIGHT );
+        ret = compare_weights( flags, str1, len1, str2, len2, UNICODE_WEIGHT );
+        if (!ret)
+        {
+            if (!(flags & NORM_IGNORENONSPACE))
+                ret = compare_weights( flags, str1, len1, str2, len2, DIACRITIC_WEIGHT );
+            if (!ret && !(flags & NORM_IGNORECASE))
+                ret = compare_weights( flags, str1, len1, str2, len2, CASE_WEIGHT );
+        }
     }
     if (!ret) return CSTR_EQUAL;
     return (ret < 0) ? CSTR_LESS_THAN : CSTR_GREATER_THAN;
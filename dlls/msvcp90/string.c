@@ -1153,6 +1153,18 @@ basic_string_char* __thiscall MSVCP_basic_string_char_append_ch(
     return MSVCP_basic_string_char_append_len_ch(this, 1, ch);
 }
 
+/* Builds left+right in ret with a single allocation */
+static basic_string_char* basic_string_char_concatenate(basic_string_char *ret,
+        const char *left, MSVCP_size_t left_len, const char *right, MSVCP_size_t right_len)
+{
+    MSVCP_basic_string_char_ctor(ret);
+    if(MSVCP_basic_string_char_npos-left_len > right_len)
+        MSVCP_basic_string_char_reserve(ret, left_len+right_len);
+    MSVCP_basic_string_char_append_cstr_len(ret, left, left_len);
+    MSVCP_basic_string_char_append_cstr_len(ret, right, right_len);
+    return ret;
+}
+
 /* ??$?HDU?$char_traits@D@std@@V?$allocator@D@1@@std@@YA?AV?$basic_string@DU?$char_traits@D@std@@V?$allocator@D@2@@0@ABV10@PBD@Z */
 /* ??$?HDU?$char_traits@D@std@@V?$allocator@D@1@@std@@YA?AV?$basic_string@DU?$char_traits@D@std@@V?$allocator@D@2@@0@AEBV10@PEBD@Z */
 /* ??Hstd@@YA?AV?$basic_string@DU?$char_traits@D@std@@V?$allocator@D@2@@0@ABV10@PBD@Z */
@@ -1162,9 +1174,8 @@ basic_string_char* __cdecl MSVCP_basic_string_char_concatenate_bstr_cstr(basic_s
 {
     TRACE("%p %s\n", left, debugstr_a(right));
 
-    MSVCP_basic_string_char_copy_ctor(ret, left);
-    MSVCP_basic_string_char_append_cstr(ret, right);
-    return ret;
+    return basic_string_char_concatenate(ret, basic_string_char_const_ptr(left),
+            left->size, right, MSVCP_char_traits_char_length(right));
 }
 
 /* ??$?HDU?$char_traits@D@std@@V?$allocator@D@1@@std@@YA?AV?$basic_string@DU?$char_traits@D@std@@V?$allocator@D@2@@0@PBDABV10@@Z */
@@ -1176,9 +1187,8 @@ basic_string_char* __cdecl MSVCP_basic_string_char_concatenate_cstr_bstr(basic_s
 {
     TRACE("%s %p\n", debugstr_a(left), right);
 
-    MSVCP_basic_string_char_ctor_cstr(ret, left);
-    MSVCP_basic_string_char_append(ret, right);
-    return ret;
+    return basic_string_char_concatenate(ret, left, MSVCP_char_traits_char_length(left),
+            basic_string_char_const_ptr(right), right->size);
 }
 
 /* ??$?HDU?$char_traits@D@std@@V?$allocator@D@1@@std@@YA?AV?$basic_string@DU?$char_traits@D@std@@V?$allocator@D@2@@0@ABV10@0@Z */
@@ -1190,9 +1200,8 @@ basic_string_char* __cdecl MSVCP_basic_string_char_concatenate(basic_string_char
 {
     TRACE("%p %p\n", left, right);
 
-    MSVCP_basic_string_char_copy_ctor(ret, left);
-    MSVCP_basic_string_char_append(ret, right);
-    return ret;
+    return basic_string_char_concatenate(ret, basic_string_char_const_ptr(left),
+            left->size, basic_string_char_const_ptr(right), right->size);
 }
 
 /* ??$?HDU?$char_traits@D@std@@V?$allocator@D@1@@std@@YA?AV?$basic_string@DU?$char_traits@D@std@@V?$allocator@D@2@@0@ABV10@D@Z */
@@ -1204,9 +1213,8 @@ basic_string_char* __cdecl MSVCP_basic_string_char_concatenate_bstr_ch(basic_str
 {
     TRACE("%p %c\n", left, right);
 
-    MSVCP_basic_string_char_copy_ctor(ret, left);
-    MSVCP_basic_string_char_append_ch(ret, right);
-    return ret;
+    return basic_string_char_concatenate(ret, basic_string_char_const_ptr(left),
+            left->size, &right, 1);
 }
 
 /* ??$?HDU?$char_traits@D@std@@V?$allocator@D@1@@std@@YA?AV?$basic_string@DU?$char_traits@D@std@@V?$allocator@D@2@@0@DABV10@@Z */
@@ -1218,9 +1226,8 @@ basic_string_char* __cdecl MSVCP_basic_string_char_concatenate_ch_bstr(basic_str
 {
     TRACE("%c %p\n", left, right);
 
-    MSVCP_basic_string_char_ctor_cstr_len(ret, &left, 1);
-    MSVCP_basic_string_char_append(ret, right);
-    return ret;
+    return basic_string_char_concatenate(ret, &left, 1,
+            basic_string_char_const_ptr(right), right->size);
 }
 
 /* ?compare@?$basic_string@DU?$char_traits@D@std@@V?$allocator@D@2@@std@@QBEHIIPBDI@Z */
@@ -1580,6 +1587,14 @@ MSVCP_size_t __thiscall MSVCP_basic_string_char_rfind_ch(
     return MSVCP_basic_string_char_rfind_cstr_substr(this, &ch, pos, 1);
 }
 
+/* Fills set with characters from find, set needs to have 256 elements */
+static void char_set_init(MSVCP_bool *set, const unsigned char *find, MSVCP_size_t len)
+{
+    memset(set, 0, 256*sizeof(*set));
+    while(len--)
+        set[*find++] = TRUE;
+}
+
 /* ?find_first_of@?$basic_string@DU?$char_traits@D@std@@V?$allocator@D@2@@std@@QBEIPBDII@Z */
 /* ?find_first_of@?$basic_string@DU?$char_traits@D@std@@V?$allocator@D@2@@std@@QEBA_KPEBD_K1@Z */
 DEFINE_THISCALL_WRAPPER(MSVCP_basic_string_char_find_first_of_cstr_substr, 16)
@@ -1587,13 +1602,20 @@ MSVCP_size_t __thiscall MSVCP_basic_string_char_find_first_of_cstr_substr(
         const basic_string_char *this, const char *find, MSVCP_size_t off, MSVCP_size_t len)
 {
     const char *p, *end;
+    MSVCP_bool set[256];
 
     TRACE("%p %p %lu %lu\n", this, find, off, len);
 
-    if(len>0 && off<this->size) {
+    if(len==1 && off<this->size) {
+        p = MSVCP_char_traits_char_find(basic_string_char_const_ptr(this)+off,
+                this->size-off, find);
+        if(p)
+            return p-basic_string_char_const_ptr(this);
+    } else if(len>0 && off<this->size) {
+        char_set_init(set, (const unsigned char*)find, len);
         end = basic_string_char_const_ptr(this)+this->size;
         for(p=basic_string_char_const_ptr(this)+off; p<end; p++)
-            if(MSVCP_char_traits_char_find(find, len, p))
+            if(set[(unsigned char)*p])
                 return p-basic_string_char_const_ptr(this);
     }
 
@@ -1822,13 +1844,15 @@ MSVCP_size_t __thiscall MSVCP_basic_string_char_find_first_not_of_cstr_substr(
         const basic_string_char *this, const char *find, MSVCP_size_t off, MSVCP_size_t len)
 {
     const char *p, *end;
+    MSVCP_bool set[256];
 
     TRACE("%p %p %lu %lu\n", this, find, off, len);
 
     if(off<this->size) {
+        char_set_init(set, (const unsigned char*)find, len);
         end = basic_string_char_const_ptr(this)+this->size;
         for(p=basic_string_char_const_ptr(this)+off; p<end; p++)
-            if(!MSVCP_char_traits_char_find(find, len, p))
+            if(!set[(unsigned char)*p])
                 return p-basic_string_char_const_ptr(this);
     }
 
@@ -1871,6 +1895,7 @@ MSVCP_size_t __thiscall MSVCP_basic_string_char_find_last_of_cstr_substr(
         const basic_string_char *this, const char *find, MSVCP_size_t off, MSVCP_size_t len)
 {
     const char *p, *beg;
+    MSVCP_bool set[256];
 
     TRACE("%p %p %lu %lu\n", this, find, off, len);
 
@@ -1878,9 +1903,10 @@ MSVCP_size_t __thiscall MSVCP_basic_string_char_find_last_of_cstr_substr(
         if(off >= this->size)
             off = this->size-1;
 
+        char_set_init(set, (const unsigned char*)find, len);
         beg = basic_string_char_const_ptr(this);
         for(p=beg+off; p>=beg; p--)
-            if(MSVCP_char_traits_char_find(find, len, p))
+            if(set[(unsigned char)*p])
                 return p-beg;
     }
 
@@ -1923,6 +1949,7 @@ MSVCP_size_t __thiscall MSVCP_basic_string_char_find_last_not_of_cstr_substr(
         const basic_string_char *this, const char *find, MSVCP_size_t off, MSVCP_size_t len)
 {
     const char *p, *beg;
+    MSVCP_bool set[256];
 
     TRACE("%p %p %lu %lu\n", this, find, off, len);
 
@@ -1930,9 +1957,10 @@ MSVCP_size_t __thiscall MSVCP_basic_string_char_find_last_not_of_cstr_substr(
         if(off >= this->size)
             off = this->size-1;
 
+        char_set_init(set, (const unsigned char*)find, len);
         beg = basic_string_char_const_ptr(this);
         for(p=beg+off; p>=beg; p--)
-            if(!MSVCP_char_traits_char_find(find, len, p))
+            if(!set[(unsigned char)*p])
                 return p-beg;
     }
 
@@ -3010,6 +3038,18 @@ basic_string_wchar* __thiscall MSVCP_basic_string_wchar_append_ch(
     return MSVCP_basic_string_wchar_append_len_ch(this, 1, ch);
 }
 
+/* Builds left+right in ret with a single allocation */
+static basic_string_wchar* basic_string_wchar_concatenate(basic_string_wchar *ret,
+        const wchar_t *left, MSVCP_size_t left_len, const wchar_t *right, MSVCP_size_t right_len)
+{
+    MSVCP_basic_string_wchar_ctor(ret);
+    if(MSVCP_basic_string_wchar_npos-left_len > right_len)
+        MSVCP_basic_string_wchar_reserve(ret, left_len+right_len);
+    MSVCP_basic_string_wchar_append_cstr_len(ret, left, left_len);
+    MSVCP_basic_string_wchar_append_cstr_len(ret, right, right_len);
+    return ret;
+}
+
 /* ??$?H_WU?$char_traits@_W@std@@V?$allocator@_W@1@@std@@YA?AV?$basic_string@_WU?$char_traits@_W@std@@V?$allocator@_W@2@@0@ABV10@PB_W@Z */
 /* ??$?H_WU?$char_traits@_W@std@@V?$allocator@_W@1@@std@@YA?AV?$basic_string@_WU?$char_traits@_W@std@@V?$allocator@_W@2@@0@AEBV10@PEB_W@Z */
 /* ??$?HGU?$char_traits@G@std@@V?$allocator@G@1@@std@@YA?AV?$basic_string@GU?$char_traits@G@std@@V?$allocator@G@2@@0@ABV10@PBG@Z */
@@ -3022,9 +3062,8 @@ basic_string_wchar* __cdecl MSVCP_basic_string_wchar_concatenate_bstr_cstr(basic
 {
     TRACE("%p %s\n", left, debugstr_w(right));
 
-    MSVCP_basic_string_wchar_copy_ctor(ret, left);
-    MSVCP_basic_string_wchar_append_cstr(ret, right);
-    return ret;
+    return basic_string_wchar_concatenate(ret, basic_string_wchar_const_ptr(left),
+            left->size, right, MSVCP_char_traits_wchar_length(right));
 }
 
 /* ??$?H_WU?$char_traits@_W@std@@V?$allocator@_W@1@@std@@YA?AV?$basic_string@_WU?$char_traits@_W@std@@V?$allocator@_W@2@@0@PB_WABV10@@Z */
@@ -3039,9 +3078,8 @@ basic_string_wchar* __cdecl MSVCP_basic_string_wchar_concatenate_cstr_bstr(basic
 {
     TRACE("%s %p\n", debugstr_w(left), right);
 
-    MSVCP_basic_string_wchar_ctor_cstr(ret, left);
-    MSVCP_basic_string_wchar_append(ret, right);
-    return ret;
+    return basic_string_wchar_concatenate(ret, left, MSVCP_char_traits_wchar_length(left),
+            basic_string_wchar_const_ptr(right), right->size);
 }
 
 /* ??$?H_WU?$char_traits@_W@std@@V?$allocator@_W@1@@std@@YA?AV?$basic_string@_WU?$char_traits@_W@std@@V?$allocator@_W@2@@0@ABV10@0@Z */
@@ -3056,9 +3094,8 @@ basic_string_wchar* __cdecl MSVCP_basic_string_wchar_concatenate(basic_string_wc
 {
     TRACE("%p %p\n", left, right);
 
-    MSVCP_basic_string_wchar_copy_ctor(ret, left);
-    MSVCP_basic_string_wchar_append(ret, right);
-    return ret;
+    return basic_string_wchar_concatenate(ret, basic_string_wchar_const_ptr(left),
+            left->size, basic_string_wchar_const_ptr(right), right->size);
 }
 
 /* ??$?H_WU?$char_traits@_W@std@@V?$allocator@_W@1@@std@@YA?AV?$basic_string@_WU?$char_traits@_W@std@@V?$allocator@_W@2@@0@ABV10@_W@Z */
@@ -3073,9 +3110,8 @@ basic_string_wchar* __cdecl MSVCP_basic_string_wchar_concatenate_bstr_ch(
 {
     TRACE("%p %c\n", left, right);
 
-    MSVCP_basic_string_wchar_copy_ctor(ret, left);
-    MSVCP_basic_string_wchar_append_ch(ret, right);
-    return ret;
+    return basic_string_wchar_concatenate(ret, basic_string_wchar_const_ptr(left),
+            left->size, &right, 1);
 }
 
 /* ??$?H_WU?$char_traits@_W@std@@V?$allocator@_W@1@@std@@YA?AV?$basic_string@_WU?$char_traits@_W@std@@V?$allocator@_W@2@@0@_WABV10@@Z */
@@ -3090,9 +3126,8 @@ basic_string_wchar* __cdecl MSVCP_basic_string_wchar_concatenate_ch_bstr(
 {
     TRACE("%c %p\n", left, right);
 
-    MSVCP_basic_string_wchar_ctor_cstr_len(ret, &left, 1);
-    MSVCP_basic_string_wchar_append(ret, right);
-    return ret;
+    return basic_string_wchar_concatenate(ret, &left, 1,
+            basic_string_wchar_const_ptr(right), right->size);
 }
 
 /* ?compare@?$basic_string@_WU?$char_traits@_W@std@@V?$allocator@_W@2@@std@@QBEHIIPB_WI@Z */
@@ -3522,6 +3557,14 @@ MSVCP_size_t __thiscall MSVCP_basic_string_wchar_rfind_ch(
     return MSVCP_basic_string_wchar_rfind_cstr_substr(this, &ch, pos, 1);
 }
 
+/* Marks low bytes of characters from find in set, set needs to have 256 elements */
+static void wchar_set_init(MSVCP_bool *set, const wchar_t *find, MSVCP_size_t len)
+{
+    memset(set, 0, 256*sizeof(*set));
+    while(len--)
+        set[*find++ & 0xff] = TRUE;
+}
+
 /* ?find_first_of@?$basic_string@_WU?$char_traits@_W@std@@V?$allocator@_W@2@@std@@QBEIPB_WII@Z */
 /* ?find_first_of@?$basic_string@_WU?$char_traits@_W@std@@V?$allocator@_W@2@@std@@QEBA_KPEB_W_K1@Z */
 /* ?find_first_of@?$basic_string@GU?$char_traits@G@std@@V?$allocator@G@2@@std@@QBEIPBGII@Z */
@@ -3531,13 +3574,20 @@ MSVCP_size_t __thiscall MSVCP_basic_string_wchar_find_first_of_cstr_substr(
         const basic_string_wchar *this, const wchar_t *find, MSVCP_size_t off, MSVCP_size_t len)
 {
     const wchar_t *p, *end;
+    MSVCP_bool set[256];
 
     TRACE("%p %p %lu %lu\n", this, find, off, len);
 
-    if(len>0 && off<this->size) {
+    if(len==1 && off<this->size) {
+        p = MSVCP_char_traits_wchar_find(basic_string_wchar_const_ptr(this)+off,
+                this->size-off, find);
+        if(p)
+            return p-basic_string_wchar_const_ptr(this);
+    } else if(len>0 && off<this->size) {
+        wchar_set_init(set, find, len);
         end = basic_string_wchar_const_ptr(this)+this->size;
         for(p=basic_string_wchar_const_ptr(this)+off; p<end; p++)
-            if(MSVCP_char_traits_wchar_find(find, len, p))
+            if(set[*p & 0xff] && MSVCP_char_traits_wchar_find(find, len, p))
                 return p-basic_string_wchar_const_ptr(this);
     }
 
@@ -3588,13 +3638,15 @@ MSVCP_size_t __thiscall MSVCP_basic_string_wchar_find_first_not_of_cstr_substr(
         const basic_string_wchar *this, const wchar_t *find, MSVCP_size_t off, MSVCP_size_t len)
 {
     const wchar_t *p, *end;
+    MSVCP_bool set[256];
 
     TRACE("%p %p %lu %lu\n", this, find, off, len);
 
     if(off<this->size) {
+        wchar_set_init(set, find, len);
         end = basic_string_wchar_const_ptr(this)+this->size;
         for(p=basic_string_wchar_const_ptr(this)+off; p<end; p++)
-            if(!MSVCP_char_traits_wchar_find(find, len, p))
+            if(!set[*p & 0xff] || !MSVCP_char_traits_wchar_find(find, len, p))
                 return p-basic_string_wchar_const_ptr(this);
     }
 
@@ -3645,6 +3697,7 @@ MSVCP_size_t __thiscall MSVCP_basic_string_wchar_find_last_of_cstr_substr(
         const basic_string_wchar *this, const wchar_t *find, MSVCP_size_t off, MSVCP_size_t len)
 {
     const wchar_t *p, *beg;
+    MSVCP_bool set[256];
 
     TRACE("%p %p %lu %lu\n", this, find, off, len);
 
@@ -3653,9 +3706,10 @@ MSVCP_size_t __thiscall MSVCP_basic_string_wchar_find_last_of_cstr_substr(
         if(off >= this->size)
             off = this->size-1;
 
+        wchar_set_init(set, find, len);
         beg = basic_string_wchar_const_ptr(this);
         for(p=beg+off; p>=beg; p--)
-            if(MSVCP_char_traits_wchar_find(find, len, p))
+            if(set[*p & 0xff] && MSVCP_char_traits_wchar_find(find, len, p))
                 return p-beg;
     }
 
@@ -3706,6 +3760,7 @@ MSVCP_size_t __thiscall MSVCP_basic_string_wchar_find_last_not_of_cstr_substr(
         const basic_string_wchar *this, const wchar_t *find, MSVCP_size_t off, MSVCP_size_t len)
 {
     const wchar_t *p, *beg;
+    MSVCP_bool set[256];
 
     TRACE("%p %p %lu %lu\n", this, find, off, len);
 
@@ -3713,9 +3768,10 @@ MSVCP_size_t __thiscall MSVCP_basic_string_wchar_find_last_not_of_cstr_substr(
         if(off >= this->size)
             off = this->size-1;
 
+        wchar_set_init(set, find, len);
         beg = basic_string_wchar_const_ptr(this);
         for(p=beg+off; p>=beg; p--)
-            if(!MSVCP_char_traits_wchar_find(find, len, p))
+            if(!set[*p & 0xff] || !MSVCP_char_traits_wchar_find(find, len, p))
                 return p-beg;
     }
 
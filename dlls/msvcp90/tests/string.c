@@ -741,6 +741,9 @@ static void test_basic_string_char_find_last_not_of(void) {
         { "ABCDE", "ABCDE", 0, 5, -1 },
         { "ABCDE", "ABCDE", 5, 5, -1 },
         { "ABCDE", "AB DE", 5, 5,  2 },
+        { "ABCDE", "EDCBA", 5, 2,  2 },
+        { "AB\xe9\xe9", "\xe9", 5, 1, 1 },
+        { "\xe9\xe9\xe9", "A\xe9", 5, 2, -1 },
 
         /* cases where find appears in multiple spots */
         { "ABABA", "A", 0, 1, -1 },
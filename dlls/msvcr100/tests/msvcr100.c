@@ -170,8 +170,8 @@ struct SchedulerVtbl {
     unsigned int (__thiscall *Release)(Scheduler*);
     void (__thiscall *RegisterShutdownEvent)(Scheduler*,HANDLE);
     void (__thiscall *Attach)(Scheduler*);
-    /* CreateScheduleGroup */
-    /* ScheduleTask */
+    void* (__thiscall *CreateScheduleGroup)(Scheduler*);
+    void (__thiscall *ScheduleTask)(Scheduler*,void (__cdecl*)(void*),void*);
 };
 
 static int* (__cdecl *p_errno)(void);
@@ -956,6 +956,24 @@ static void test_ExternalContextBase(void)
     CloseHandle(thread);
 }
 
+#define SCHEDULED_TASK_COUNT 200
+
+static LONG scheduled_task_count;
+static HANDLE scheduled_task_event;
+static Scheduler *scheduled_task_scheduler;
+
+static void __cdecl scheduled_task(void *arg)
+{
+    Scheduler *scheduler = p_CurrentScheduler_Get();
+
+    ok(arg == &scheduled_task_count, "arg = %p\n", arg);
+    ok(scheduler == scheduled_task_scheduler, "CurrentScheduler::Get() = %p, expected %p\n",
+            scheduler, scheduled_task_scheduler);
+
+    if(InterlockedIncrement(&scheduled_task_count) == SCHEDULED_TASK_COUNT)
+        SetEvent(scheduled_task_event);
+}
+
 static void test_Scheduler(void)
 {
     Scheduler *scheduler, *current_scheduler;
@@ -986,6 +1004,22 @@ static void test_Scheduler(void)
     i = call_func1(scheduler->vtable->GetNumberOfVirtualProcessors, scheduler);
     ok(i == 1, "Scheduler::GetNumberOfVirtualProcessors() = %u\n", i);
     call_func1(scheduler->vtable->Release, scheduler);
+
+    call_func3(p_SchedulerPolicy_SetConcurrencyLimits, &policy, 1, 4);
+    scheduler = p_Scheduler_Create(&policy);
+    ok(scheduler != NULL, "Scheduler::Create() = NULL\n");
+
+    scheduled_task_event = CreateEventW(NULL, FALSE, FALSE, NULL);
+    scheduled_task_scheduler = scheduler;
+    for(i=0; i<SCHEDULED_TASK_COUNT; i++)
+        call_func3(scheduler->vtable->ScheduleTask, scheduler, scheduled_task, &scheduled_task_count);
+    call_func1(scheduler->vtable->Release, scheduler);
+    i = WaitForSingleObject(scheduled_task_event, 5000);
+    ok(i == WAIT_OBJECT_0, "WaitForSingleObject returned %u\n", i);
+    ok(scheduled_task_count == SCHEDULED_TASK_COUNT, "scheduled_task_count = %d\n",
+            scheduled_task_count);
+    CloseHandle(scheduled_task_event);
+
     call_func1(p_SchedulerPolicy_dtor, &policy);
 }
 
@@ -519,18 +519,157 @@ static inline int FUNC_NAME(pf_output_hex_fp)(FUNC_NAME(puts_clbk) pf_puts, void
     return len;
 }
 
-static inline void FUNC_NAME(pf_rebuild_format_string)(char *p, FUNC_NAME(pf_flags) *flags)
+/* pf_fp_digits: stores exact decimal digits of v >= 0 (without leading and
+   trailing zeros) in digits and returns their count; v = 0.digits * 10^dp */
+static inline int FUNC_NAME(pf_fp_digits)(char *digits, double v, int *dp)
 {
-    *p++ = '%';
-    if(flags->Alternate)
-        *p++ = flags->Alternate;
-    if(flags->Precision >= 0) {
-        *p++ = '.';
-        MSVCRT__itoa(flags->Precision, p, 10);
-        p += strlen(p);
+    static const DWORD p5[] = { 1, 5, 25, 125, 625, 3125, 15625, 78125, 390625,
+        1953125, 9765625, 48828125, 244140625 };
+    DWORD limbs[90], carry, mult;
+    ULONGLONG bits, m, t;
+    int e2, k, len, i, n;
+
+    memcpy(&bits, &v, sizeof(bits));
+    m = bits & (((ULONGLONG)1 << 52) - 1);
+    e2 = (bits >> 52) & 0x7ff;
+    if(e2) m |= (ULONGLONG)1 << 52;
+    else e2 = 1;
+    e2 -= 1075;
+
+    *dp = 1;
+    if(!m)
+        return 0;
+    while(!(m & 1)) {
+        m >>= 1;
+        e2++;
+    }
+
+    /* v = m * 2^e2, or m * 5^-e2 * 10^e2 if e2 is negative */
+    for(len=0; m; len++) {
+        limbs[len] = m % 1000000000;
+        m /= 1000000000;
+    }
+    for(k=(e2 < 0 ? -e2 : e2); k; k-=i) {
+        if(e2 > 0) {
+            i = min(k, 29);
+            mult = 1 << i;
+        } else {
+            i = min(k, 12);
+            mult = p5[i];
+        }
+
+        for(carry=0, n=0; n<len; n++) {
+            t = (ULONGLONG)limbs[n] * mult + carry;
+            limbs[n] = t % 1000000000;
+            carry = t / 1000000000;
+        }
+        if(carry) limbs[len++] = carry;
+    }
+
+    for(n=0, carry=limbs[len-1]; carry; carry/=10) n++;
+    for(i=n-1, carry=limbs[len-1]; i>=0; i--, carry/=10)
+        digits[i] = '0' + carry % 10;
+    for(k=len-2; k>=0; k--, n+=9) {
+        for(i=8, carry=limbs[k]; i>=0; i--, carry/=10)
+            digits[n+i] = '0' + carry % 10;
+    }
+
+    *dp = n + (e2 < 0 ? e2 : 0);
+    while(digits[n-1] == '0')
+        n--;
+    return n;
+}
+
+/* pf_fp_round: rounds digits to keep significant digits using round-half-even */
+static inline int FUNC_NAME(pf_fp_round)(char *digits, int n, int keep, int *dp)
+{
+    BOOL up;
+
+    if(keep >= n)
+        return n;
+    if(keep < 0)
+        return 0;
+
+    if(digits[keep] != '5')
+        up = digits[keep] > '5';
+    else
+        up = keep+1 < n || (keep && (digits[keep-1] - '0') % 2);
+
+    if(!up) {
+        n = keep;
+    } else {
+        for(n=keep; n>0 && digits[n-1]=='9'; n--);
+        if(!n) {
+            digits[n++] = '1';
+            (*dp)++;
+        } else {
+            digits[n-1]++;
+        }
+    }
+
+    while(n && digits[n-1] == '0')
+        n--;
+    return n;
+}
+
+/* pf_fp_conv: prints finite v >= 0 to buf in %e, %f or %g format,
+   without field characters or the sign */
+static inline void FUNC_NAME(pf_fp_conv)(char *buf, double v, FUNC_NAME(pf_flags) *flags)
+{
+    char digits[800], format = MSVCRT__tolower_l(flags->Format, NULL);
+    int prec = flags->Precision < 0 ? 6 : flags->Precision;
+    int n, dp, exp, frac, i;
+
+    n = FUNC_NAME(pf_fp_digits)(digits, v, &dp);
+
+    if(format == 'g') {
+        if(!prec) prec = 1;
+        n = FUNC_NAME(pf_fp_round)(digits, n, prec, &dp);
+
+        if(dp-1 < -4 || dp-1 >= prec) {
+            format = 'e';
+            prec--;
+        } else {
+            format = 'f';
+            prec -= dp;
+        }
+
+        if(!flags->Alternate) {
+            frac = format == 'e' ? n-1 : n-dp;
+            if(prec > frac) prec = max(frac, 0);
+        }
     }
-    *p++ = flags->Format;
-    *p++ = 0;
+
+    if(format == 'e') {
+        n = FUNC_NAME(pf_fp_round)(digits, n, prec+1, &dp);
+        exp = n ? dp-1 : 0;
+
+        *buf++ = n ? digits[0] : '0';
+        if(prec || flags->Alternate)
+            *buf++ = '.';
+        for(i=1; i<=prec; i++)
+            *buf++ = i < n ? digits[i] : '0';
+
+        *buf++ = MSVCRT__toupper_l(flags->Format, NULL) == flags->Format ? 'E' : 'e';
+        *buf++ = exp < 0 ? '-' : '+';
+        if(exp < 0) exp = -exp;
+        if(exp >= 100)
+            *buf++ = '0' + exp / 100;
+        *buf++ = '0' + exp / 10 % 10;
+        *buf++ = '0' + exp % 10;
+    } else {
+        n = FUNC_NAME(pf_fp_round)(digits, n, dp+prec, &dp);
+
+        if(dp <= 0)
+            *buf++ = '0';
+        for(i=0; i<dp; i++)
+            *buf++ = i < n ? digits[i] : '0';
+        if(prec || flags->Alternate)
+            *buf++ = '.';
+        for(i=dp; i<dp+prec; i++)
+            *buf++ = i >= 0 && i < n ? digits[i] : '0';
+    }
+    *buf = 0;
 }
 
 /* pf_integer_conv:  prints x to buf, including alternate formats and
@@ -850,7 +989,7 @@ int FUNC_NAME(pf_printf)(FUNC_NAME(puts_clbk) pf_puts, void *puts_ctx, const API
             if(tmp != buf)
                 HeapFree(GetProcessHeap(), 0, tmp);
         } else if(flags.Format && strchr("aAeEfFgG", flags.Format)) {
-            char float_fmt[20], buf_a[32], *tmp = buf_a, *decimal_point;
+            char buf_a[32], *tmp = buf_a, *decimal_point;
             int len = flags.Precision + 10;
             double val = pf_args(args_ctx, pos, VT_R8, valist).get_double;
             int r;
@@ -883,9 +1022,7 @@ int FUNC_NAME(pf_printf)(FUNC_NAME(puts_clbk) pf_puts, void *puts_ctx, const API
                 if(!tmp)
                     return -1;
 
-                FUNC_NAME(pf_rebuild_format_string)(float_fmt, &flags);
-
-                sprintf(tmp, float_fmt, val);
+                FUNC_NAME(pf_fp_conv)(tmp, val, &flags);
                 if(MSVCRT__toupper_l(flags.Format, NULL)=='E' || MSVCRT__toupper_l(flags.Format, NULL)=='G')
                     FUNC_NAME(pf_fixup_exponent)(tmp, three_digit_exp);
 
@@ -84,11 +84,14 @@ struct scheduler_list {
     struct scheduler_list *next;
 };
 
+struct scheduler_worker;
+
 typedef struct {
     Context context;
     struct scheduler_list scheduler;
     unsigned int id;
     union allocator_cache_entry *allocator_cache[8];
+    struct scheduler_worker *worker;
 } ExternalContextBase;
 extern const vtable_ptr MSVCRT_ExternalContextBase_vtable;
 static void ExternalContextBase_ctor(ExternalContextBase*);
@@ -130,9 +133,39 @@ typedef struct {
     int shutdown_size;
     HANDLE *shutdown_events;
     CRITICAL_SECTION cs;
+    struct scheduler_pool *pool;
 } ThreadScheduler;
 extern const vtable_ptr MSVCRT_ThreadScheduler_vtable;
 
+struct scheduled_task {
+    void (__cdecl *proc)(void*);
+    void *data;
+    Scheduler *scheduler;
+};
+
+/* Every worker owns a deque of tasks. The owner pushes and pops at the
+ * tail, idle workers steal the oldest tasks from the head. */
+struct scheduler_worker {
+    struct scheduler_pool *pool;
+    CRITICAL_SECTION cs;
+    struct scheduled_task *tasks;
+    unsigned int head;
+    unsigned int count;
+    unsigned int size;
+};
+
+struct scheduler_pool {
+    LONG ref;
+    LONG queued;
+    LONG idle;
+    LONG next;
+    BOOL shutdown;
+    CRITICAL_SECTION cs;
+    CONDITION_VARIABLE cv;
+    unsigned int worker_count;
+    struct scheduler_worker workers[1];
+};
+
 typedef struct {
     Scheduler *scheduler;
 } _Scheduler;
@@ -142,6 +175,7 @@ typedef struct {
 } _CurrentScheduler;
 
 static int context_tls_index = TLS_OUT_OF_INDEXES;
+static HMODULE msvcrt_module;
 
 static CRITICAL_SECTION default_scheduler_cs;
 static CRITICAL_SECTION_DEBUG default_scheduler_cs_debug =
@@ -598,6 +632,187 @@ void __thiscall SchedulerPolicy_dtor(SchedulerPolicy *this)
     MSVCRT_operator_delete(this->policy_container);
 }
 
+static void scheduler_pool_release(struct scheduler_pool *pool)
+{
+    unsigned int i;
+
+    if(InterlockedDecrement(&pool->ref))
+        return;
+
+    for(i=0; i<pool->worker_count; i++) {
+        pool->workers[i].cs.DebugInfo->Spare[0] = 0;
+        DeleteCriticalSection(&pool->workers[i].cs);
+        MSVCRT_operator_delete(pool->workers[i].tasks);
+    }
+    pool->cs.DebugInfo->Spare[0] = 0;
+    DeleteCriticalSection(&pool->cs);
+    MSVCRT_operator_delete(pool);
+}
+
+static void scheduler_worker_push(struct scheduler_worker *worker,
+        const struct scheduled_task *task)
+{
+    struct scheduled_task *tasks;
+    unsigned int i;
+
+    EnterCriticalSection(&worker->cs);
+    if(worker->count == worker->size) {
+        tasks = MSVCRT_operator_new(worker->size * 2 * sizeof(*tasks));
+        for(i=0; i<worker->count; i++)
+            tasks[i] = worker->tasks[(worker->head + i) & (worker->size - 1)];
+        MSVCRT_operator_delete(worker->tasks);
+        worker->tasks = tasks;
+        worker->head = 0;
+        worker->size *= 2;
+    }
+    worker->tasks[(worker->head + worker->count++) & (worker->size - 1)] = *task;
+    LeaveCriticalSection(&worker->cs);
+}
+
+static BOOL scheduler_worker_pop(struct scheduler_worker *worker,
+        struct scheduled_task *task, BOOL steal)
+{
+    BOOL ret = FALSE;
+
+    if(!worker->count)
+        return FALSE;
+
+    EnterCriticalSection(&worker->cs);
+    if(worker->count) {
+        if(steal) {
+            *task = worker->tasks[worker->head];
+            worker->head = (worker->head + 1) & (worker->size - 1);
+        }else {
+            *task = worker->tasks[(worker->head + worker->count - 1) & (worker->size - 1)];
+        }
+        worker->count--;
+        ret = TRUE;
+    }
+    LeaveCriticalSection(&worker->cs);
+    return ret;
+}
+
+static BOOL scheduler_worker_get_task(struct scheduler_worker *worker,
+        struct scheduled_task *task)
+{
+    struct scheduler_pool *pool = worker->pool;
+    unsigned int i, idx = worker - pool->workers;
+
+    if(!scheduler_worker_pop(worker, task, FALSE)) {
+        for(i=1; i<pool->worker_count; i++) {
+            if(scheduler_worker_pop(&pool->workers[(idx + i) % pool->worker_count], task, TRUE))
+                break;
+        }
+        if(i >= pool->worker_count)
+            return FALSE;
+    }
+
+    InterlockedDecrement(&pool->queued);
+    return TRUE;
+}
+
+static DWORD WINAPI scheduler_worker_proc(void *arg)
+{
+    struct scheduler_worker *worker = arg;
+    struct scheduler_pool *pool = worker->pool;
+    ExternalContextBase *context = (ExternalContextBase*)get_current_context();
+    struct scheduled_task task;
+    Scheduler *scheduler;
+    BOOL shutdown;
+
+    TRACE("(%p)\n", worker);
+
+    context->worker = worker;
+    for(;;) {
+        if(scheduler_worker_get_task(worker, &task)) {
+            scheduler = context->scheduler.scheduler;
+            context->scheduler.scheduler = task.scheduler;
+            task.proc(task.data);
+            context->scheduler.scheduler = scheduler;
+            call_Scheduler_Release(task.scheduler);
+            continue;
+        }
+
+        EnterCriticalSection(&pool->cs);
+        InterlockedIncrement(&pool->idle);
+        while(!pool->queued && !pool->shutdown)
+            SleepConditionVariableCS(&pool->cv, &pool->cs, INFINITE);
+        InterlockedDecrement(&pool->idle);
+        shutdown = pool->shutdown && !pool->queued;
+        LeaveCriticalSection(&pool->cs);
+        if(shutdown) break;
+    }
+    context->worker = NULL;
+
+    scheduler_pool_release(pool);
+    FreeLibraryAndExitThread(msvcrt_module, 0);
+}
+
+static void scheduler_pool_shutdown(struct scheduler_pool *pool)
+{
+    EnterCriticalSection(&pool->cs);
+    pool->shutdown = TRUE;
+    WakeAllConditionVariable(&pool->cv);
+    LeaveCriticalSection(&pool->cs);
+    scheduler_pool_release(pool);
+}
+
+static struct scheduler_pool* scheduler_pool_create(const SchedulerPolicy *policy,
+        unsigned int worker_count)
+{
+    unsigned int i, stack_size, priority;
+    struct scheduler_pool *pool;
+    HANDLE thread;
+
+    pool = MSVCRT_operator_new(FIELD_OFFSET(struct scheduler_pool, workers[worker_count]));
+    pool->ref = 1;
+    pool->queued = 0;
+    pool->idle = 0;
+    pool->next = 0;
+    pool->shutdown = FALSE;
+    InitializeCriticalSection(&pool->cs);
+    pool->cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": scheduler_pool");
+    InitializeConditionVariable(&pool->cv);
+    pool->worker_count = worker_count;
+
+    for(i=0; i<worker_count; i++) {
+        pool->workers[i].pool = pool;
+        InitializeCriticalSection(&pool->workers[i].cs);
+        pool->workers[i].cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": scheduler_worker");
+        pool->workers[i].head = pool->workers[i].count = 0;
+        pool->workers[i].size = 16;
+        pool->workers[i].tasks = MSVCRT_operator_new(
+                pool->workers[i].size * sizeof(*pool->workers[i].tasks));
+    }
+
+    stack_size = SchedulerPolicy_GetPolicyValue(policy, ContextStackSize) * 1024;
+    priority = SchedulerPolicy_GetPolicyValue(policy, ContextPriority);
+    for(i=0; i<worker_count; i++) {
+        /* keep the module loaded while worker threads are running */
+        if(!GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS,
+                    (const WCHAR*)scheduler_worker_proc, &msvcrt_module))
+            break;
+        InterlockedIncrement(&pool->ref);
+        thread = CreateThread(NULL, stack_size, scheduler_worker_proc, &pool->workers[i], 0, NULL);
+        if(!thread) {
+            InterlockedDecrement(&pool->ref);
+            FreeLibrary(msvcrt_module);
+            break;
+        }
+        if(priority != INHERIT_THREAD_PRIORITY)
+            SetThreadPriority(thread, priority);
+        CloseHandle(thread);
+    }
+
+    if(!i) {
+        DWORD err = GetLastError();
+        scheduler_pool_release(pool);
+        throw_exception(EXCEPTION_SCHEDULER_RESOURCE_ALLOCATION_ERROR,
+                HRESULT_FROM_WIN32(err), NULL);
+    }
+    return pool;
+}
+
 static void ThreadScheduler_dtor(ThreadScheduler *this)
 {
     int i;
@@ -609,6 +824,9 @@ static void ThreadScheduler_dtor(ThreadScheduler *this)
         SetEvent(this->shutdown_events[i]);
     MSVCRT_operator_delete(this->shutdown_events);
 
+    if(this->pool)
+        scheduler_pool_shutdown(this->pool);
+
     this->cs.DebugInfo->Spare[0] = 0;
     DeleteCriticalSection(&this->cs);
 }
@@ -717,18 +935,69 @@ DEFINE_THISCALL_WRAPPER(ThreadScheduler_CreateScheduleGroup, 4)
     return NULL;
 }
 
-DEFINE_THISCALL_WRAPPER(ThreadScheduler_ScheduleTask_loc, 16)
-void __thiscall ThreadScheduler_ScheduleTask_loc(ThreadScheduler *this,
-        void (__cdecl *proc)(void*), void* data, /*location*/void *placement)
+static struct scheduler_pool* ThreadScheduler_get_pool(ThreadScheduler *this)
 {
-    FIXME("(%p %p %p %p) stub\n", this, proc, data, placement);
+    struct scheduler_pool *pool;
+    unsigned int worker_count;
+
+    if(this->pool)
+        return this->pool;
+
+    worker_count = SchedulerPolicy_GetPolicyValue(&this->policy, MinConcurrency);
+    if(worker_count < this->virt_proc_no)
+        worker_count = this->virt_proc_no;
+    if(!worker_count)
+        worker_count = 1;
+
+    pool = scheduler_pool_create(&this->policy, worker_count);
+    if(InterlockedCompareExchangePointer((void**)&this->pool, pool, NULL)) {
+        scheduler_pool_shutdown(pool);
+        return this->pool;
+    }
+    return pool;
 }
 
 DEFINE_THISCALL_WRAPPER(ThreadScheduler_ScheduleTask, 12)
 void __thiscall ThreadScheduler_ScheduleTask(ThreadScheduler *this,
         void (__cdecl *proc)(void*), void* data)
 {
-    FIXME("(%p %p %p) stub\n", this, proc, data);
+    ExternalContextBase *context = (ExternalContextBase*)try_get_current_context();
+    struct scheduler_worker *worker = NULL;
+    struct scheduler_pool *pool;
+    struct scheduled_task task;
+
+    TRACE("(%p %p %p)\n", this, proc, data);
+
+    pool = ThreadScheduler_get_pool(this);
+
+    task.proc = proc;
+    task.data = data;
+    task.scheduler = &this->scheduler;
+    ThreadScheduler_Reference(this);
+
+    /* Tasks spawned by a worker stay on its own deque, others are spread
+     * over all workers. */
+    if(context && context->context.vtable == &MSVCRT_ExternalContextBase_vtable
+            && context->worker && context->worker->pool == pool)
+        worker = context->worker;
+    else
+        worker = &pool->workers[(ULONG)InterlockedIncrement(&pool->next) % pool->worker_count];
+    scheduler_worker_push(worker, &task);
+
+    InterlockedIncrement(&pool->queued);
+    if(pool->idle) {
+        EnterCriticalSection(&pool->cs);
+        WakeConditionVariable(&pool->cv);
+        LeaveCriticalSection(&pool->cs);
+    }
+}
+
+DEFINE_THISCALL_WRAPPER(ThreadScheduler_ScheduleTask_loc, 16)
+void __thiscall ThreadScheduler_ScheduleTask_loc(ThreadScheduler *this,
+        void (__cdecl *proc)(void*), void* data, /*location*/void *placement)
+{
+    TRACE("(%p %p %p %p)\n", this, proc, data, placement);
+    ThreadScheduler_ScheduleTask(this, proc, data);
 }
 
 DEFINE_THISCALL_WRAPPER(ThreadScheduler_IsAvailableLocation, 8)
@@ -778,6 +1047,7 @@ static ThreadScheduler* ThreadScheduler_ctor(ThreadScheduler *this,
 
     this->shutdown_count = this->shutdown_size = 0;
     this->shutdown_events = NULL;
+    this->pool = NULL;
 
     InitializeCriticalSection(&this->cs);
     this->cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": ThreadScheduler");
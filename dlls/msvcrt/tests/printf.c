@@ -209,6 +209,16 @@ static void test_sprintf( void )
         { "% 2.4e", "-8.6000e+000", 0, DOUBLE_ARG, 0, 0, -8.6 },
         { "%+2.4e", "+8.6000e+000", 0, DOUBLE_ARG, 0, 0, 8.6 },
         { "%2.4g", "8.6", 0, DOUBLE_ARG, 0, 0, 8.6 },
+        { "%.3e", "1.000e+001", 0, DOUBLE_ARG, 0, 0, 9.9996 },
+        { "%.2f", "1000.00", 0, DOUBLE_ARG, 0, 0, 999.999 },
+        { "%.3f", "0.001", 0, DOUBLE_ARG, 0, 0, 0.0006 },
+        { "%f", "0.000000", 0, DOUBLE_ARG, 0, 0, 1e-300 },
+        { "%g", "1e-005", 0, DOUBLE_ARG, 0, 0, 0.00001 },
+        { "%g", "0.0001", 0, DOUBLE_ARG, 0, 0, 0.0001 },
+        { "%g", "123457", 0, DOUBLE_ARG, 0, 0, 123456.7 },
+        { "%G", "1E+006", 0, DOUBLE_ARG, 0, 0, 999999.7 },
+        { "%#.3g", "1.00", 0, DOUBLE_ARG, 0, 0, 1.0 },
+        { "%g", "0", 0, DOUBLE_ARG, 0, 0, 0.0 },
         { "%-i", "-1", 0, INT_ARG, -1 },
         { "%-i", "1", 0, INT_ARG, 1 },
         { "%+i", "+1", 0, INT_ARG, 1 },
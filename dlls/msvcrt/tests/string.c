@@ -1962,6 +1962,52 @@ static void test__strtod(void)
         { "-0.", 3, 0 },
         { "0e13", 4, 0 },
     };
+    static const struct {
+        const char *str;
+        ULONGLONG bits;
+    } exact_tests[] = {
+        /* 17 to 19 digit mantissas with decimal exponents in [-64, 64] */
+        { "12345678901234567e-64", 0x35fcde81c958bef8 },
+        { "1234567890123456789e-64", 0x36668dd5654d5532 },
+        { "9999999999999999999e-64", 0x3696d601ad376ab9 },
+        { "9999999999999999999e64", 0x512a5b01b605557b },
+        { "1000000000000000001e64", 0x50f5159af8044462 },
+        { "4611686018427387903e-40", 0x3b816c262777579c },
+        { "18014398509481985e32", 0x49f3b8b5b5056e17 },
+        { "7205759403792793599e-50", 0x3977624f8a762fd8 },
+        { "3141592653589793238e-18", 0x400921fb54442d18 },
+        { "2718281828459045235e45", 0x4d1a6e5d1e0358e5 },
+        { "1234567890123456789e-28", 0x3de0f7bfe5e2538b },
+        { "8888888888888888888e30", 0x4a1853fe40b3c247 },
+        { "1e-64", 0x32a50ffd44f4a73d },
+        { "1e64", 0x4d384f03e93ff9f5 },
+        { "5e-64", 0x32ca53fc9631d10d },
+        { "9007199254740993e-63", 0x362a53fc9631d10d },
+        { "-1797693134862315708e-30", 0xbd7fa01712e8f046 },
+        /* halfway and nearly halfway between two doubles */
+        { "9007199254740993", 0x4340000000000000 },
+        { "9007199254740995", 0x4340000000000002 },
+        { "-9007199254740993", 0xc340000000000000 },
+        { "90071992547409930e-1", 0x4340000000000000 },
+        { "90071992547409931e-1", 0x4340000000000001 },
+        { "90071992547409929e-1", 0x4340000000000000 },
+        { "9223372036854778880", 0x43e0000000000002 },
+        { "9223372036854778879", 0x43e0000000000001 },
+        { "9223372036854778881", 0x43e0000000000002 },
+        { "1000000000000000111e-18", 0x3ff0000000000000 },
+        { "1000000000000000112e-18", 0x3ff0000000000001 },
+        { "4503599627370496.5", 0x4330000000000000 },
+        { "4503599627370497.5", 0x4330000000000002 },
+        /* just outside of the range of the fast path */
+        { "1e65", 0x4d6e62c4e38ff872 },
+        { "1e-65", 0x3270d9976a5d5297 },
+        { "12345678901234567e65", 0x50c4d2f7dbafdb97 },
+        { "12345678901234567e-65", 0x35c71867d446ff2d },
+        { "12345678901234567890", 0x43e56a95319d63e1 },
+        { "12345678901234567890e-30", 0x3dab25ffd636ec12 },
+        { "9007199254740993.0000000001", 0x4340000000000001 },
+        { "1.00000000000000011102230246251565", 0x3ff0000000000000 },
+    };
     const char overflow[] = "1d9999999999999999999";
 
     char *end;
@@ -1978,6 +2024,18 @@ static void test__strtod(void)
         ok(errno = 0xdeadbeef, "%d) errno = %d\n", i, errno);
     }
 
+    for (i=0; i<ARRAY_SIZE(exact_tests); i++)
+    {
+        ULONGLONG bits;
+
+        d = strtod(exact_tests[i].str, &end);
+        memcpy(&bits, &d, sizeof(bits));
+        ok(bits == exact_tests[i].bits, "%s: got %s, expected %s\n", exact_tests[i].str,
+                wine_dbgstr_longlong(bits), wine_dbgstr_longlong(exact_tests[i].bits));
+        ok(end == exact_tests[i].str + strlen(exact_tests[i].str), "%s: len = %d\n",
+                exact_tests[i].str, (int)(end - exact_tests[i].str));
+    }
+
     if (!p__strtod_l)
         win_skip("_strtod_l not found\n");
     else
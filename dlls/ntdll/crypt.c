@@ -50,12 +50,115 @@ typedef struct {
 #define R3(v,w,x,y,z,i) z+=f3(w,x,y)+blk1(i)+0x8F1BBCDC+rol(v,5);w=rol(w,30);
 #define R4(v,w,x,y,z,i) z+=f4(w,x,y)+blk1(i)+0xCA62C1D6+rol(v,5);w=rol(w,30);
 
+#if defined(__x86_64__) && defined(__GNUC__)
+
+static int have_shani(void)
+{
+   static int shani = -1;
+   unsigned int a, b, c, d;
+
+   if (shani == -1)
+   {
+      __asm__ ("cpuid" : "=a" (a), "=b" (b), "=c" (c), "=d" (d) : "a" (0), "c" (0));
+      shani = 0;
+      if (a >= 7)
+      {
+         __asm__ ("cpuid" : "=a" (a), "=b" (b), "=c" (c), "=d" (d) : "a" (7), "c" (0));
+         shani = (b >> 29) & 1;
+      }
+   }
+   return shani;
+}
+
+/* Four rounds with the scheduled words at offset off of W; xmm1 holds ABCD
+ * as it was before the previous four rounds. */
+#define SHA1_ROUNDS4(func,off) \
+   "movdqu " #off "(%[w]), %%xmm2\n\t" \
+   "sha1nexte %%xmm2, %%xmm1\n\t" \
+   "movdqa %%xmm0, %%xmm3\n\t" \
+   "sha1rnds4 $" #func ", %%xmm1, %%xmm0\n\t" \
+   "movdqa %%xmm3, %%xmm1\n\t"
+
+/* Same as SHA1Transform, using the SHA extensions. The scheduled words are
+ * kept in the reversed dword order that sha1rnds4 works on. */
+static void SHA1TransformSHANI(ULONG State[5], const UCHAR Buffer[64])
+{
+   static const UCHAR bswap_mask[16] = {15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0};
+   ULONG W[80], *p;
+   int count;
+
+   __asm__ __volatile__ (
+      "mov %[w], %[p]\n\t"
+      "movdqu (%[mask]), %%xmm7\n\t"
+      "movdqu (%[buf]), %%xmm2\n\t"
+      "pshufb %%xmm7, %%xmm2\n\t"
+      "movdqu %%xmm2, (%[p])\n\t"
+      "movdqu 16(%[buf]), %%xmm2\n\t"
+      "pshufb %%xmm7, %%xmm2\n\t"
+      "movdqu %%xmm2, 16(%[p])\n\t"
+      "movdqu 32(%[buf]), %%xmm2\n\t"
+      "pshufb %%xmm7, %%xmm2\n\t"
+      "movdqu %%xmm2, 32(%[p])\n\t"
+      "movdqu 48(%[buf]), %%xmm2\n\t"
+      "pshufb %%xmm7, %%xmm2\n\t"
+      "movdqu %%xmm2, 48(%[p])\n\t"
+      "movl $16, %[count]\n"
+      "1:\tmovdqu (%[p]), %%xmm2\n\t"
+      "movdqu 16(%[p]), %%xmm3\n\t"
+      "sha1msg1 %%xmm3, %%xmm2\n\t"
+      "movdqu 32(%[p]), %%xmm3\n\t"
+      "pxor %%xmm3, %%xmm2\n\t"
+      "movdqu 48(%[p]), %%xmm3\n\t"
+      "sha1msg2 %%xmm3, %%xmm2\n\t"
+      "movdqu %%xmm2, 64(%[p])\n\t"
+      "add $16, %[p]\n\t"
+      "decl %[count]\n\t"
+      "jnz 1b\n\t"
+      /* ABCD in xmm0 with A in the high dword, E in the high dword of xmm4 */
+      "movdqu (%[state]), %%xmm0\n\t"
+      "pshufd $0x1b, %%xmm0, %%xmm0\n\t"
+      "movd 16(%[state]), %%xmm4\n\t"
+      "pslldq $12, %%xmm4\n\t"
+      "movdqa %%xmm0, %%xmm5\n\t"
+      "movdqu (%[w]), %%xmm1\n\t"
+      "paddd %%xmm4, %%xmm1\n\t"
+      "movdqa %%xmm0, %%xmm3\n\t"
+      "sha1rnds4 $0, %%xmm1, %%xmm0\n\t"
+      "movdqa %%xmm3, %%xmm1\n\t"
+      SHA1_ROUNDS4(0,16)  SHA1_ROUNDS4(0,32)  SHA1_ROUNDS4(0,48)  SHA1_ROUNDS4(0,64)
+      SHA1_ROUNDS4(1,80)  SHA1_ROUNDS4(1,96)  SHA1_ROUNDS4(1,112) SHA1_ROUNDS4(1,128)
+      SHA1_ROUNDS4(1,144) SHA1_ROUNDS4(2,160) SHA1_ROUNDS4(2,176) SHA1_ROUNDS4(2,192)
+      SHA1_ROUNDS4(2,208) SHA1_ROUNDS4(2,224) SHA1_ROUNDS4(3,240) SHA1_ROUNDS4(3,256)
+      SHA1_ROUNDS4(3,272) SHA1_ROUNDS4(3,288) SHA1_ROUNDS4(3,304)
+      /* E after the last four rounds, plus the original E */
+      "sha1nexte %%xmm4, %%xmm1\n\t"
+      "paddd %%xmm5, %%xmm0\n\t"
+      "pshufd $0x1b, %%xmm0, %%xmm0\n\t"
+      "movdqu %%xmm0, (%[state])\n\t"
+      "pextrd $3, %%xmm1, 16(%[state])\n\t"
+      : [p] "=&r" (p), [count] "=&r" (count)
+      : [buf] "r" (Buffer), [state] "r" (State), [w] "r" (W), [mask] "r" (bswap_mask)
+      : "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm7", "memory", "cc" );
+}
+
+#undef SHA1_ROUNDS4
+
+#endif
+
 /* Hash a single 512-bit block. This is the core of the algorithm. */
 static void SHA1Transform(ULONG State[5], UCHAR Buffer[64])
 {
    ULONG a, b, c, d, e;
    ULONG *Block;
 
+#if defined(__x86_64__) && defined(__GNUC__)
+   if (have_shani())
+   {
+      SHA1TransformSHANI(State, Buffer);
+      return;
+   }
+#endif
+
    Block = (ULONG*)Buffer;
 
    /* Copy Context->State[] to working variables */
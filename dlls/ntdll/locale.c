@@ -1598,6 +1598,38 @@ found:
 }
 
 
+/* length of the run of 7-bit ASCII chars at the start of the string, checked a word at a time */
+static inline unsigned int get_ascii_len( const char *str, unsigned int len )
+{
+    static const ULONG_PTR mask = (ULONG_PTR)~0 / 0xff * 0x80;
+    unsigned int i = 0;
+    ULONG_PTR val;
+
+    for ( ; i + sizeof(val) <= len; i += sizeof(val))
+    {
+        memcpy( &val, str + i, sizeof(val) );
+        if (val & mask) break;
+    }
+    while (i < len && !(str[i] & 0x80)) i++;
+    return i;
+}
+
+static inline unsigned int get_ascii_lenW( const WCHAR *str, unsigned int len )
+{
+    static const ULONG_PTR mask = (ULONG_PTR)~0 / 0xffff * 0xff80;
+    unsigned int i = 0;
+    ULONG_PTR val;
+
+    for ( ; i + sizeof(val) / sizeof(WCHAR) <= len; i += sizeof(val) / sizeof(WCHAR))
+    {
+        memcpy( &val, str + i, sizeof(val) );
+        if (val & mask) break;
+    }
+    while (i < len && str[i] < 0x80) i++;
+    return i;
+}
+
+
 /* helper for the various utf8 mbstowcs functions */
 static unsigned int decode_utf8_char( unsigned char ch, const char **str, const char *strend )
 {
@@ -1656,7 +1688,7 @@ static unsigned int decode_utf8_char( unsigned char ch, const char **str, const
  */
 NTSTATUS WINAPI RtlUTF8ToUnicodeN( WCHAR *dst, DWORD dstlen, DWORD *reslen, const char *src, DWORD srclen )
 {
-    unsigned int res, len;
+    unsigned int i, res, len;
     NTSTATUS status = STATUS_SUCCESS;
     const char *srcend = src + srclen;
     WCHAR *dstend;
@@ -1670,8 +1702,15 @@ NTSTATUS WINAPI RtlUTF8ToUnicodeN( WCHAR *dst, DWORD dstlen, DWORD *reslen, cons
     {
         for (len = 0; src < srcend; len++)
         {
-            unsigned char ch = *src++;
-            if (ch < 0x80) continue;
+            unsigned char ch;
+
+            /* special fast case for runs of 7-bit ASCII */
+            i = get_ascii_len( src, srcend - src );
+            src += i;
+            len += i;
+            if (src == srcend) break;
+
+            ch = *src++;
             if ((res = decode_utf8_char( ch, &src, srcend )) > 0x10ffff)
                 status = STATUS_SOME_NOT_MAPPED;
             else
@@ -1683,12 +1722,16 @@ NTSTATUS WINAPI RtlUTF8ToUnicodeN( WCHAR *dst, DWORD dstlen, DWORD *reslen, cons
 
     while ((dst < dstend) && (src < srcend))
     {
-        unsigned char ch = *src++;
-        if (ch < 0x80)  /* special fast case for 7-bit ASCII */
-        {
-            *dst++ = ch;
-            continue;
-        }
+        unsigned char ch;
+
+        /* special fast case for runs of 7-bit ASCII */
+        len = get_ascii_len( src, min( srcend - src, dstend - dst ));
+        for (i = 0; i < len; i++) dst[i] = (unsigned char)src[i];
+        src += len;
+        dst += len;
+        if (dst == dstend || src == srcend) break;
+
+        ch = *src++;
         if ((res = decode_utf8_char( ch, &src, srcend )) <= 0xffff)
         {
             *dst++ = res;
@@ -1759,8 +1802,13 @@ NTSTATUS WINAPI RtlUnicodeToUTF8N( char *dst, DWORD dstlen, DWORD *reslen, const
 
         if (ch < 0x80)  /* 0x00-0x7f: 1 byte */
         {
-            if (dst > end - 1) break;
-            *dst++ = ch;
+            unsigned int i, ascii_len = get_ascii_lenW( src, min( srclen, end - dst ));
+
+            if (!ascii_len) break;
+            for (i = 0; i < ascii_len; i++) dst[i] = src[i];
+            dst += ascii_len;
+            src += ascii_len - 1;
+            srclen -= ascii_len - 1;
             continue;
         }
         if (ch < 0x800)  /* 0x80-0x7ff: 2 bytes */
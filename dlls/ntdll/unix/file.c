@@ -55,6 +55,9 @@
 #ifdef HAVE_SYS_SOCKET_H
 #include <sys/socket.h>
 #endif
+#ifdef HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
 #ifdef HAVE_SYS_TIME_H
 # include <sys/time.h>
 #endif
@@ -2507,6 +2510,256 @@ NTSTATUS WINAPI NtQueryDirectoryFile( HANDLE handle, HANDLE event, PIO_APC_ROUTI
 }
 
 
+/* cache of directory listings used for case-insensitive lookups */
+
+#define DIR_CACHE_SIZE        8
+#define DIR_CACHE_MAX_ENTRIES 65536
+
+struct dir_cache_entry
+{
+    const char   *unix_name;      /* name on disk */
+    const WCHAR  *name;           /* name converted to Unicode */
+    unsigned int  len;            /* length of name in chars */
+    unsigned int  next;           /* index + 1 of next entry in the same hash bucket */
+};
+
+struct dir_cache
+{
+    struct file_identity    id;           /* identity of the directory */
+    time_t                  mtime;        /* modification time of the directory when it was read */
+    long                    mtime_nsec;
+    unsigned int            last_use;     /* for choosing the entry to replace */
+    unsigned int            count;        /* number of entries */
+    unsigned int            hash_size;    /* number of hash buckets, a power of 2 */
+    unsigned int           *buckets;      /* index + 1 of first entry in each bucket */
+    struct dir_cache_entry *entries;      /* entries in readdir order */
+    char                   *data;         /* storage for the names */
+};
+
+static struct dir_cache dir_cache[DIR_CACHE_SIZE];
+static unsigned int dir_cache_use, dir_cache_hits, dir_cache_misses;
+static pthread_mutex_t dir_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static inline long get_mtime_nsec( const struct stat *st )
+{
+#ifdef HAVE_STRUCT_STAT_ST_MTIM
+    return st->st_mtim.tv_nsec;
+#elif defined(HAVE_STRUCT_STAT_ST_MTIMESPEC)
+    return st->st_mtimespec.tv_nsec;
+#else
+    return 0;
+#endif
+}
+
+static unsigned int hash_dir_entry_name( const WCHAR *name, unsigned int len )
+{
+    unsigned int i, hash = 0;
+
+    for (i = 0; i < len; i++) hash = hash * 31 + ntdll_towupper( name[i] );
+    return hash;
+}
+
+static void free_dir_cache( struct dir_cache *cache )
+{
+    free( cache->buckets );
+    free( cache->entries );
+    free( cache->data );
+    memset( cache, 0, sizeof(*cache) );
+}
+
+/* read the directory listing into a cache slot; returns FALSE if it can't be cached */
+static BOOL fill_dir_cache( struct dir_cache *cache, const char *dir_name, const struct stat *st )
+{
+    unsigned int i, count = 0, max_count = 64, data_size = 0, data_max = 4096;
+    struct dir_cache_entry *entries;
+    char *data, *new_data;
+    struct dirent *de;
+    DIR *dir;
+
+    if (!(dir = opendir( dir_name ))) return FALSE;
+
+    entries = malloc( max_count * sizeof(*entries) );
+    data = malloc( data_max );
+    if (!entries || !data) goto failed;
+
+    /* names are stored as offsets into data until it is no longer reallocated */
+    while ((de = readdir( dir )))
+    {
+        unsigned int unix_len = strlen( de->d_name ) + 1;
+        unsigned int size = (unix_len + 1) & ~1;
+        WCHAR buffer[MAX_DIR_ENTRY_LEN];
+        int len;
+
+        len = ntdll_umbstowcs( de->d_name, unix_len - 1, buffer, MAX_DIR_ENTRY_LEN );
+        if (len < 0) len = 0;
+
+        if (count == DIR_CACHE_MAX_ENTRIES) goto failed;
+        if (count == max_count)
+        {
+            struct dir_cache_entry *new_entries;
+
+            max_count *= 2;
+            if (!(new_entries = realloc( entries, max_count * sizeof(*entries) ))) goto failed;
+            entries = new_entries;
+        }
+        while (data_size + size + len * sizeof(WCHAR) > data_max)
+        {
+            data_max *= 2;
+            if (!(new_data = realloc( data, data_max ))) goto failed;
+            data = new_data;
+        }
+
+        entries[count].unix_name = (const char *)(ULONG_PTR)data_size;
+        memcpy( data + data_size, de->d_name, unix_len );
+        data_size += size;
+        entries[count].name = (const WCHAR *)(ULONG_PTR)data_size;
+        memcpy( data + data_size, buffer, len * sizeof(WCHAR) );
+        data_size += len * sizeof(WCHAR);
+        entries[count].len = len;
+        count++;
+    }
+    closedir( dir );
+    dir = NULL;
+
+    cache->hash_size = 16;
+    while (cache->hash_size < count) cache->hash_size *= 2;
+    if (!(cache->buckets = calloc( cache->hash_size, sizeof(*cache->buckets) ))) goto failed;
+
+    /* link the entries backwards so that each bucket is in readdir order */
+    for (i = count; i--;)
+    {
+        unsigned int bucket;
+
+        entries[i].unix_name = data + (ULONG_PTR)entries[i].unix_name;
+        entries[i].name = (const WCHAR *)(data + (ULONG_PTR)entries[i].name);
+        bucket = hash_dir_entry_name( entries[i].name, entries[i].len ) & (cache->hash_size - 1);
+        entries[i].next = cache->buckets[bucket];
+        cache->buckets[bucket] = i + 1;
+    }
+
+    cache->id.dev     = st->st_dev;
+    cache->id.ino     = st->st_ino;
+    cache->mtime      = st->st_mtime;
+    cache->mtime_nsec = get_mtime_nsec( st );
+    cache->count      = count;
+    cache->entries    = entries;
+    cache->data       = data;
+    return TRUE;
+
+failed:
+    if (dir) closedir( dir );
+    free( entries );
+    free( data );
+    free( cache->buckets );
+    cache->buckets = NULL;
+    return FALSE;
+}
+
+/* find the cached listing of a directory, reading it if needed */
+static struct dir_cache *get_dir_cache( const char *dir_name )
+{
+    struct dir_cache *cache, *lru = dir_cache;
+    struct stat st;
+    unsigned int i;
+
+    if (stat( dir_name, &st ) == -1) return NULL;
+
+    for (i = 0; i < DIR_CACHE_SIZE; i++)
+    {
+        cache = &dir_cache[i];
+        if (cache->entries && is_same_file( &cache->id, &st ))
+        {
+            if (cache->mtime == st.st_mtime && cache->mtime_nsec == get_mtime_nsec( &st ))
+            {
+                cache->last_use = ++dir_cache_use;
+                dir_cache_hits++;
+                return cache;
+            }
+            free_dir_cache( cache );  /* the directory changed */
+            lru = cache;
+            break;
+        }
+        if (cache->last_use < lru->last_use) lru = cache;
+    }
+
+    dir_cache_misses++;
+
+    /* don't cache a directory modified in the current second, the modification
+     * time may not change on further modifications if it has a coarse granularity */
+    if (st.st_mtime >= time( NULL ) - 1) return NULL;
+
+    free_dir_cache( lru );
+    if (!fill_dir_cache( lru, dir_name, &st )) return NULL;
+    lru->last_use = ++dir_cache_use;
+    return lru;
+}
+
+/***********************************************************************
+ *           find_file_in_dir_cache
+ *
+ * Case-insensitive search of a file name in the cached directory listing.
+ * unix_name contains the directory name, followed by a null at pos - 1.
+ * Returns 1 if found (and appends it to unix_name), 0 if not found, and
+ * -1 if the directory listing could not be cached.
+ */
+static int find_file_in_dir_cache( char *unix_name, int pos, const WCHAR *name, int length,
+                                   BOOLEAN is_name_8_dot_3 )
+{
+    const struct dir_cache_entry *entry, *found = NULL;
+    struct dir_cache *cache;
+    sigset_t sigset;
+    unsigned int i;
+
+    server_enter_uninterrupted_section( &dir_cache_mutex, &sigset );
+
+    if (!(cache = get_dir_cache( unix_name )))
+    {
+        server_leave_uninterrupted_section( &dir_cache_mutex, &sigset );
+        return -1;
+    }
+
+    if (is_name_8_dot_3)
+    {
+        /* short names need to be computed, check all the entries in order */
+        for (i = 0; i < cache->count && !found; i++)
+        {
+            WCHAR short_nameW[12];
+            int ret;
+
+            entry = &cache->entries[i];
+            if (entry->len == length && !wcsnicmp( entry->name, name, length )) found = entry;
+            else if (!is_legal_8dot3_name( entry->name, entry->len ))
+            {
+                ret = hash_short_file_name( entry->name, entry->len, short_nameW );
+                if (ret == length && !wcsnicmp( short_nameW, name, length )) found = entry;
+            }
+        }
+    }
+    else
+    {
+        i = cache->buckets[hash_dir_entry_name( name, length ) & (cache->hash_size - 1)];
+        while (i && !found)
+        {
+            entry = &cache->entries[i - 1];
+            if (entry->len == length && !wcsnicmp( entry->name, name, length )) found = entry;
+            i = entry->next;
+        }
+    }
+
+    if (found)
+    {
+        unix_name[pos - 1] = '/';
+        strcpy( unix_name + pos, found->unix_name );
+    }
+
+    TRACE( "%s in %s: %s (%u hits, %u misses)\n", debugstr_wn(name, length), debugstr_a(unix_name),
+           found ? "found" : "not found", dir_cache_hits, dir_cache_misses );
+
+    server_leave_uninterrupted_section( &dir_cache_mutex, &sigset );
+    return found != NULL;
+}
+
+
 /***********************************************************************
  *           find_file_in_dir
  *
@@ -2599,6 +2852,12 @@ static NTSTATUS find_file_in_dir( char *unix_name, int pos, const WCHAR *name, i
     }
 #endif /* VFAT_IOCTL_READDIR_BOTH */
 
+    switch (find_file_in_dir_cache( unix_name, pos, name, length, is_name_8_dot_3 ))
+    {
+    case 1: goto success;
+    case 0: goto not_found;
+    }
+
     if (!(dir = opendir( unix_name )))
     {
         if (errno == ENOENT) return STATUS_OBJECT_PATH_NOT_FOUND;
@@ -5184,6 +5443,25 @@ err:
 }
 
 
+#ifdef HAVE_PREADV
+/* fill an iovec array with the page-sized segments of a scatter/gather request */
+static int get_segments_iov( struct iovec *iov, int max_count, const FILE_SEGMENT_ELEMENT *segments,
+                             ULONG pos, ULONG length )
+{
+    int count;
+
+    for (count = 0; count < max_count && length; count++, segments++)
+    {
+        iov[count].iov_base = (char *)segments->Buffer + pos;
+        iov[count].iov_len  = min( length, page_size - pos );
+        length -= iov[count].iov_len;
+        pos = 0;
+    }
+    return count;
+}
+#endif
+
+
 /******************************************************************************
  *              NtReadFileScatter   (NTDLL.@)
  */
@@ -5217,11 +5495,21 @@ NTSTATUS WINAPI NtReadFileScatter( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
 
     while (length)
     {
+#ifdef HAVE_PREADV
+        struct iovec iov[64];
+        int count = get_segments_iov( iov, ARRAY_SIZE(iov), segments, pos, length );
+
+        if (offset && offset->QuadPart != FILE_USE_FILE_POINTER_POSITION)
+            result = preadv( unix_handle, iov, count, offset->QuadPart + total );
+        else
+            result = readv( unix_handle, iov, count );
+#else
         if (offset && offset->QuadPart != FILE_USE_FILE_POINTER_POSITION)
             result = pread( unix_handle, (char *)segments->Buffer + pos,
                             min( length - pos, page_size - pos ), offset->QuadPart + total );
         else
             result = read( unix_handle, (char *)segments->Buffer + pos, min( length - pos, page_size - pos ) );
+#endif
 
         if (result == -1)
         {
@@ -5232,11 +5520,9 @@ NTSTATUS WINAPI NtReadFileScatter( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
         if (!result) break;
         total += result;
         length -= result;
-        if ((pos += result) == page_size)
-        {
-            pos = 0;
-            segments++;
-        }
+        pos += result;
+        segments += pos / page_size;
+        pos %= page_size;
     }
 
     if (total == 0) status = STATUS_END_OF_FILE;
@@ -5520,11 +5806,21 @@ NTSTATUS WINAPI NtWriteFileGather( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
 
     while (length)
     {
+#if defined(HAVE_PREADV) && defined(HAVE_PWRITEV)
+        struct iovec iov[64];
+        int count = get_segments_iov( iov, ARRAY_SIZE(iov), segments, pos, length );
+
+        if (offset && offset->QuadPart != FILE_USE_FILE_POINTER_POSITION)
+            result = pwritev( unix_handle, iov, count, offset->QuadPart + total );
+        else
+            result = writev( unix_handle, iov, count );
+#else
         if (offset && offset->QuadPart != FILE_USE_FILE_POINTER_POSITION)
             result = pwrite( unix_handle, (char *)segments->Buffer + pos,
                              page_size - pos, offset->QuadPart + total );
         else
             result = write( unix_handle, (char *)segments->Buffer + pos, page_size - pos );
+#endif
 
         if (result == -1)
         {
@@ -5544,11 +5840,9 @@ NTSTATUS WINAPI NtWriteFileGather( HANDLE file, HANDLE event, PIO_APC_ROUTINE ap
         }
         total += result;
         length -= result;
-        if ((pos += result) == page_size)
-        {
-            pos = 0;
-            segments++;
-        }
+        pos += result;
+        segments += pos / page_size;
+        pos %= page_size;
     }
 
     send_completion = cvalue != 0;
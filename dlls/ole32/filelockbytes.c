@@ -51,10 +51,16 @@ typedef struct FileLockBytesImpl
     HANDLE hfile;
     DWORD flProtect;
     LPWSTR pwcsName;
+    HANDLE hmapping;
+    BYTE *mapped;
+    ULARGE_INTEGER mappedSize;
 } FileLockBytesImpl;
 
 static const ILockBytesVtbl FileLockBytesImpl_Vtbl;
 
+/* larger files keep using ReadFile rather than taking up address space */
+#define MAX_MAPPED_FILE_SIZE (16 * 1024 * 1024)
+
 static inline FileLockBytesImpl *impl_from_ILockBytes(ILockBytes *iface)
 {
     return CONTAINING_RECORD(iface, FileLockBytesImpl, ILockBytes_iface);
@@ -81,6 +87,45 @@ static DWORD GetProtectMode(DWORD openFlags)
     return PAGE_READONLY;
 }
 
+/****************************************************************************
+ *      FileLockBytesImpl_MapFile
+ *
+ * Map the whole file into memory, so that reads don't need to go through
+ * ReadFile. This is only done for files of moderate size, and when nobody can
+ * modify the file while we have it open, i.e. when it's opened read-only and
+ * denying write access.
+ */
+static void FileLockBytesImpl_MapFile(FileLockBytesImpl *This, DWORD openFlags)
+{
+    LARGE_INTEGER size;
+
+    if (This->flProtect != PAGE_READONLY)
+        return;
+
+    if (STGM_SHARE_MODE(openFlags) != STGM_SHARE_DENY_WRITE &&
+        STGM_SHARE_MODE(openFlags) != STGM_SHARE_EXCLUSIVE)
+        return;
+
+    if (!GetFileSizeEx(This->hfile, &size) || !size.QuadPart ||
+        size.QuadPart > MAX_MAPPED_FILE_SIZE)
+        return;
+
+    This->hmapping = CreateFileMappingW(This->hfile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!This->hmapping)
+        return;
+
+    This->mapped = MapViewOfFile(This->hmapping, FILE_MAP_READ, 0, 0, 0);
+    if (!This->mapped)
+    {
+        CloseHandle(This->hmapping);
+        This->hmapping = NULL;
+        return;
+    }
+
+    This->mappedSize.QuadPart = size.QuadPart;
+    TRACE("mapped %s bytes at %p\n", wine_dbgstr_longlong(size.QuadPart), This->mapped);
+}
+
 /******************************************************************************
  *      FileLockBytesImpl_Construct
  *
@@ -103,6 +148,9 @@ HRESULT FileLockBytesImpl_Construct(HANDLE hFile, DWORD openFlags, LPCWSTR pwcsN
   This->ref = 1;
   This->hfile = hFile;
   This->flProtect = GetProtectMode(openFlags);
+  This->hmapping = NULL;
+  This->mapped = NULL;
+  This->mappedSize.QuadPart = 0;
 
   if(pwcsName) {
     if (!GetFullPathNameW(pwcsName, MAX_PATH, fullpath, NULL))
@@ -121,6 +169,8 @@ HRESULT FileLockBytesImpl_Construct(HANDLE hFile, DWORD openFlags, LPCWSTR pwcsN
   else
     This->pwcsName = NULL;
 
+  FileLockBytesImpl_MapFile(This, openFlags);
+
   *pLockBytes = &This->ILockBytes_iface;
 
   return S_OK;
@@ -159,6 +209,11 @@ static ULONG WINAPI FileLockBytesImpl_Release(ILockBytes *iface)
 
     if (ref == 0)
     {
+        if (This->mapped)
+        {
+            UnmapViewOfFile(This->mapped);
+            CloseHandle(This->hmapping);
+        }
         CloseHandle(This->hfile);
         HeapFree(GetProcessHeap(), 0, This->pwcsName);
         HeapFree(GetProcessHeap(), 0, This);
@@ -197,6 +252,20 @@ static HRESULT WINAPI FileLockBytesImpl_ReadAt(
     if (pcbRead)
         *pcbRead = 0;
 
+    if (This->mapped)
+    {
+        if (ulOffset.QuadPart >= This->mappedSize.QuadPart)
+            return STG_E_READFAULT;
+
+        cbRead = min(cb, This->mappedSize.QuadPart - ulOffset.QuadPart);
+        memcpy(pv, This->mapped + ulOffset.QuadPart, cbRead);
+
+        if (pcbRead)
+            *pcbRead = cbRead;
+
+        return cbRead == cb ? S_OK : STG_E_READFAULT;
+    }
+
     offset.QuadPart = ulOffset.QuadPart;
 
     ret = SetFilePointerEx(This->hfile, offset, NULL, FILE_BEGIN);
@@ -685,9 +685,22 @@ static HRESULT WINAPI ClientRpcChannelBuffer_GetBuffer(LPRPCCHANNELBUFFER iface,
                                   &message_state->params.iface);
     if (hr == S_OK)
     {
-        /* stub, chan, iface and iid are unneeded in multi-threaded case as we go
-         * via the RPC runtime */
+        /* the object lives in this process, so the call can be handed to its
+         * apartment directly instead of going through the RPC runtime */
         if (apt->multi_threaded)
+            message_state->params.bypass_rpcrt = TRUE;
+        else
+        {
+            message_state->target_hwnd = apartment_getwindow(apt);
+            message_state->target_tid = apt->tid;
+            if (message_state->target_hwnd)
+                message_state->params.bypass_rpcrt = TRUE;
+            else
+                ERR("window for apartment %s is NULL\n", wine_dbgstr_longlong(apt->oxid));
+        }
+
+        /* stub, chan, iface and iid are unneeded if we go via the RPC runtime */
+        if (!message_state->params.bypass_rpcrt)
         {
             IRpcStubBuffer_Release(message_state->params.stub);
             message_state->params.stub = NULL;
@@ -695,16 +708,6 @@ static HRESULT WINAPI ClientRpcChannelBuffer_GetBuffer(LPRPCCHANNELBUFFER iface,
             message_state->params.chan = NULL;
             message_state->params.iface = NULL;
         }
-        else
-        {
-            message_state->params.bypass_rpcrt = TRUE;
-            message_state->target_hwnd = apartment_getwindow(apt);
-            message_state->target_tid = apt->tid;
-            /* we assume later on that this being non-NULL is the indicator that
-             * means call directly instead of going through RPC runtime */
-            if (!message_state->target_hwnd)
-                ERR("window for apartment %s is NULL\n", wine_dbgstr_longlong(apt->oxid));
-        }
     }
     if (apt) apartment_release(apt);
     message_state->params.handle = ClientRpcChannelBuffer_GetEventHandle(This);
@@ -712,7 +715,7 @@ static HRESULT WINAPI ClientRpcChannelBuffer_GetBuffer(LPRPCCHANNELBUFFER iface,
      * ClientRpcChannelBuffer_SendReceive */
 
     /* shortcut the RPC runtime */
-    if (message_state->target_hwnd)
+    if (message_state->params.bypass_rpcrt)
     {
         msg->Buffer = HeapAlloc(GetProcessHeap(), 0, msg->BufferLength);
         if (msg->Buffer)
@@ -803,6 +806,73 @@ static DWORD WINAPI rpc_sendreceive_thread(LPVOID param)
     return 0;
 }
 
+/* runs an incoming call for the multi-threaded apartment of this process on
+ * the current thread, unless the thread can't join that apartment */
+static HRESULT rpc_execute_in_mta(struct dispatch_params *params)
+{
+    struct oletls *info = COM_CurrentInfo();
+    HRESULT hr;
+
+    if (!info)
+        return E_OUTOFMEMORY;
+
+    hr = enter_apartment(info, COINIT_MULTITHREADED);
+    if (FAILED(hr))
+        return hr;
+
+    if (!info->apt->multi_threaded)
+        hr = RPC_E_CHANGED_MODE;
+    else
+    {
+        RPC_ExecuteCall(params);
+        hr = S_OK;
+    }
+    leave_apartment(info);
+
+    return hr;
+}
+
+static DWORD WINAPI rpc_execute_mta_thread(LPVOID param)
+{
+    struct dispatch_params *params = param;
+    HRESULT hr;
+
+    if (FAILED(hr = rpc_execute_in_mta(params)))
+    {
+        ERR("failed to join the multi-threaded apartment, hr %#x\n", hr);
+        params->hr = hr;
+        SetEvent(params->handle);
+    }
+
+    return 0;
+}
+
+/* this thread runs an incoming call for the multi-threaded apartment of this
+ * process without going through the RPC runtime */
+static DWORD WINAPI rpc_execute_thread(LPVOID param)
+{
+    struct dispatch_params *params = param;
+    HANDLE thread;
+    HRESULT hr;
+
+    if (SUCCEEDED(hr = rpc_execute_in_mta(params)))
+        return 0;
+
+    /* the pool thread already belongs to a single-threaded apartment, so run
+     * the call on a thread of its own */
+    TRACE("can't execute call on this thread, hr %#x\n", hr);
+    if (!(thread = CreateThread(NULL, 0, rpc_execute_mta_thread, params, 0, NULL)))
+    {
+        ERR("CreateThread failed with error %u\n", GetLastError());
+        params->hr = HRESULT_FROM_WIN32(GetLastError());
+        SetEvent(params->handle);
+        return 0;
+    }
+    CloseHandle(thread);
+
+    return 0;
+}
+
 static inline HRESULT ClientRpcChannelBuffer_IsCorrectApartment(ClientRpcChannelBuffer *This, APARTMENT *apt)
 {
     OXID oxid;
@@ -867,7 +937,7 @@ static HRESULT WINAPI ClientRpcChannelBuffer_SendReceive(LPRPCCHANNELBUFFER ifac
      * from DllMain */
 
     message_state->params.msg = olemsg;
-    if (message_state->params.bypass_rpcrt)
+    if (message_state->params.bypass_rpcrt && message_state->target_hwnd)
     {
         TRACE("Calling apartment thread 0x%08x...\n", message_state->target_tid);
 
@@ -884,6 +954,22 @@ static HRESULT WINAPI ClientRpcChannelBuffer_SendReceive(LPRPCCHANNELBUFFER ifac
             hr = HRESULT_FROM_WIN32(GetLastError());
         }
     }
+    else if (message_state->params.bypass_rpcrt)
+    {
+        TRACE("Calling multi-threaded apartment...\n");
+
+        msg->ProcNum &= ~RPC_FLAGS_VALID_BIT;
+
+        /* the calling thread keeps pumping messages while it waits below, as
+         * it does for calls going through the RPC runtime */
+        if (!QueueUserWorkItem(rpc_execute_thread, &message_state->params, WT_EXECUTEDEFAULT))
+        {
+            ERR("QueueUserWorkItem failed with error %u\n", GetLastError());
+            hr = E_UNEXPECTED;
+        }
+        else
+            hr = S_OK;
+    }
     else
     {
         /* we use a separate thread here because we need to be able to
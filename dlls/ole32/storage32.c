@@ -193,11 +193,15 @@ typedef struct BlockChainBlock
 {
   ULONG index;
   ULONG sector;
+  ULONG lastUse;
   BOOL  read;
   BOOL  dirty;
   BYTE data[MAX_BIG_BLOCK_SIZE];
 } BlockChainBlock;
 
+/* Number of blocks to cache in a BlockChainStream */
+#define BLOCKCHAIN_BLOCK_CACHE_SIZE 4
+
 struct BlockChainStream
 {
   StorageImpl* parentStorage;
@@ -206,8 +210,8 @@ struct BlockChainStream
   struct BlockChainRun* indexCache;
   ULONG        indexCacheLen;
   ULONG        indexCacheSize;
-  BlockChainBlock cachedBlocks[2];
-  ULONG        blockToEvict;
+  BlockChainBlock cachedBlocks[BLOCKCHAIN_BLOCK_CACHE_SIZE];
+  ULONG        blockCacheUse;
   ULONG        tailIndex;
   ULONG        numBlocks;
 };
@@ -4029,6 +4033,7 @@ static HRESULT StorageImpl_GetNextBlockInChain(
   BYTE depotBuffer[MAX_BIG_BLOCK_SIZE];
   ULONG read;
   ULONG depotBlockIndexPos;
+  BlockDepotCacheEntry *cached = NULL;
   int index, num_blocks;
 
   *nextBlockIndex   = BLOCK_SPECIAL;
@@ -4041,11 +4046,23 @@ static HRESULT StorageImpl_GetNextBlockInChain(
   }
 
   /*
-   * Cache the currently accessed depot block.
+   * Look for the depot block in the cache, evicting the least recently
+   * used entry if it isn't there.
    */
-  if (depotBlockCount != This->indexBlockDepotCached)
+  for (index = 0; index < BLOCKDEPOT_CACHE_SIZE; index++)
+  {
+    if (This->blockDepotCache[index].index == depotBlockCount)
+    {
+      cached = &This->blockDepotCache[index];
+      break;
+    }
+    if (!cached || This->blockDepotCache[index].lastUse < cached->lastUse)
+      cached = &This->blockDepotCache[index];
+  }
+
+  if (cached->index != depotBlockCount)
   {
-    This->indexBlockDepotCached = depotBlockCount;
+    cached->index = 0xFFFFFFFF;
 
     if (depotBlockCount < COUNT_BBDEPOTINHEADER)
     {
@@ -4067,13 +4084,13 @@ static HRESULT StorageImpl_GetNextBlockInChain(
     num_blocks = This->bigBlockSize / 4;
 
     for (index = 0; index < num_blocks; index++)
-    {
-      StorageUtl_ReadDWord(depotBuffer, index*sizeof(ULONG), nextBlockIndex);
-      This->blockDepotCached[index] = *nextBlockIndex;
-    }
+      StorageUtl_ReadDWord(depotBuffer, index*sizeof(ULONG), &cached->data[index]);
+
+    cached->index = depotBlockCount;
   }
 
-  *nextBlockIndex = This->blockDepotCached[depotBlockOffset/sizeof(ULONG)];
+  cached->lastUse = ++This->blockDepotCacheUse;
+  *nextBlockIndex = cached->data[depotBlockOffset/sizeof(ULONG)];
 
   return S_OK;
 }
@@ -4127,6 +4144,7 @@ static void StorageImpl_SetNextBlockInChain(
   ULONG depotBlockCount  = offsetInDepot / This->bigBlockSize;
   ULONG depotBlockOffset = offsetInDepot % This->bigBlockSize;
   ULONG depotBlockIndexPos;
+  int i;
 
   assert(depotBlockCount < This->bigBlockDepotCount);
   assert(blockIndex != nextBlock);
@@ -4155,9 +4173,13 @@ static void StorageImpl_SetNextBlockInChain(
   /*
    * Update the cached block depot, if necessary.
    */
-  if (depotBlockCount == This->indexBlockDepotCached)
+  for (i = 0; i < BLOCKDEPOT_CACHE_SIZE; i++)
   {
-    This->blockDepotCached[depotBlockOffset/sizeof(ULONG)] = nextBlock;
+    if (This->blockDepotCache[i].index == depotBlockCount)
+    {
+      This->blockDepotCache[i].data[depotBlockOffset/sizeof(ULONG)] = nextBlock;
+      break;
+    }
   }
 }
 
@@ -4626,6 +4648,7 @@ static HRESULT StorageImpl_Refresh(StorageImpl *This, BOOL new_object, BOOL crea
   DirEntry currentEntry;
   DirRef      currentEntryRef;
   BlockChainStream *blockChainStream;
+  int i;
 
   if (create)
   {
@@ -4692,7 +4715,12 @@ static HRESULT StorageImpl_Refresh(StorageImpl *This, BOOL new_object, BOOL crea
   /*
    * There is no block depot cached yet.
    */
-  This->indexBlockDepotCached = 0xFFFFFFFF;
+  for (i = 0; i < BLOCKDEPOT_CACHE_SIZE; i++)
+  {
+    This->blockDepotCache[i].index = 0xFFFFFFFF;
+    This->blockDepotCache[i].lastUse = 0;
+  }
+  This->blockDepotCacheUse = 0;
   This->indexExtBlockDepotCached = 0xFFFFFFFF;
 
   /*
@@ -7180,15 +7208,12 @@ static HRESULT BlockChainStream_UpdateIndexCache(BlockChainStream* This)
   return S_OK;
 }
 
-/* Locate the nth block in this stream. */
-static ULONG BlockChainStream_GetSectorOfOffset(BlockChainStream *This, ULONG offset)
+/* Locate the run containing the nth block in this stream. */
+static ULONG BlockChainStream_GetRunOfOffset(BlockChainStream *This, ULONG offset)
 {
   ULONG min_offset = 0, max_offset = This->numBlocks-1;
   ULONG min_run = 0, max_run = This->indexCacheLen-1;
 
-  if (offset >= This->numBlocks)
-    return BLOCK_END_OF_CHAIN;
-
   while (min_run < max_run)
   {
     ULONG run_to_check = min_run + (offset - min_offset) * (max_run - min_run) / (max_offset - min_offset);
@@ -7207,7 +7232,41 @@ static ULONG BlockChainStream_GetSectorOfOffset(BlockChainStream *This, ULONG of
       min_run = max_run = run_to_check;
   }
 
-  return This->indexCache[min_run].firstSector + offset - This->indexCache[min_run].firstOffset;
+  return min_run;
+}
+
+/* Locate the nth block in this stream. */
+static ULONG BlockChainStream_GetSectorOfOffset(BlockChainStream *This, ULONG offset)
+{
+  ULONG run;
+
+  if (offset >= This->numBlocks)
+    return BLOCK_END_OF_CHAIN;
+
+  run = BlockChainStream_GetRunOfOffset(This, offset);
+
+  return This->indexCache[run].firstSector + offset - This->indexCache[run].firstOffset;
+}
+
+/* Count how many blocks, starting with the nth one and up to max_blocks, are
+ * stored in consecutive sectors and not in the block cache, so they can be
+ * transferred with a single read or write. */
+static ULONG BlockChainStream_GetContiguousBlocks(BlockChainStream *This, ULONG offset, ULONG max_blocks)
+{
+  ULONG run, count;
+  int i;
+
+  if (offset >= This->numBlocks)
+    return 0;
+
+  run = BlockChainStream_GetRunOfOffset(This, offset);
+  count = min(max_blocks, This->indexCache[run].lastOffset - offset + 1);
+
+  for (i=0; i<BLOCKCHAIN_BLOCK_CACHE_SIZE; i++)
+    if (This->cachedBlocks[i].index >= offset && This->cachedBlocks[i].index - offset < count)
+      count = This->cachedBlocks[i].index - offset;
+
+  return count;
 }
 
 static HRESULT BlockChainStream_GetBlockAtOffset(BlockChainStream *This,
@@ -7216,11 +7275,12 @@ static HRESULT BlockChainStream_GetBlockAtOffset(BlockChainStream *This,
   BlockChainBlock *result=NULL;
   int i;
 
-  for (i=0; i<2; i++)
+  for (i=0; i<BLOCKCHAIN_BLOCK_CACHE_SIZE; i++)
     if (This->cachedBlocks[i].index == index)
     {
       *sector = This->cachedBlocks[i].sector;
       *block = &This->cachedBlocks[i];
+      (*block)->lastUse = ++This->blockCacheUse;
       return S_OK;
     }
 
@@ -7230,15 +7290,16 @@ static HRESULT BlockChainStream_GetBlockAtOffset(BlockChainStream *This,
 
   if (create)
   {
-    if (This->cachedBlocks[0].index == 0xffffffff)
-      result = &This->cachedBlocks[0];
-    else if (This->cachedBlocks[1].index == 0xffffffff)
-      result = &This->cachedBlocks[1];
-    else
+    /* Use a free entry if there is one, or evict the least recently used. */
+    for (i=0; i<BLOCKCHAIN_BLOCK_CACHE_SIZE; i++)
     {
-      result = &This->cachedBlocks[This->blockToEvict++];
-      if (This->blockToEvict == 2)
-        This->blockToEvict = 0;
+      if (This->cachedBlocks[i].index == 0xffffffff)
+      {
+        result = &This->cachedBlocks[i];
+        break;
+      }
+      if (!result || This->cachedBlocks[i].lastUse < result->lastUse)
+        result = &This->cachedBlocks[i];
     }
 
     if (result->dirty)
@@ -7251,6 +7312,7 @@ static HRESULT BlockChainStream_GetBlockAtOffset(BlockChainStream *This,
     result->read = FALSE;
     result->index = index;
     result->sector = *sector;
+    result->lastUse = ++This->blockCacheUse;
   }
 
   *block = result;
@@ -7263,6 +7325,7 @@ BlockChainStream* BlockChainStream_Construct(
   DirRef         dirEntry)
 {
   BlockChainStream* newStream;
+  int i;
 
   newStream = HeapAlloc(GetProcessHeap(), 0, sizeof(BlockChainStream));
   if(!newStream)
@@ -7274,11 +7337,13 @@ BlockChainStream* BlockChainStream_Construct(
   newStream->indexCache              = NULL;
   newStream->indexCacheLen           = 0;
   newStream->indexCacheSize          = 0;
-  newStream->cachedBlocks[0].index = 0xffffffff;
-  newStream->cachedBlocks[0].dirty = FALSE;
-  newStream->cachedBlocks[1].index = 0xffffffff;
-  newStream->cachedBlocks[1].dirty = FALSE;
-  newStream->blockToEvict          = 0;
+  for (i=0; i<BLOCKCHAIN_BLOCK_CACHE_SIZE; i++)
+  {
+    newStream->cachedBlocks[i].index = 0xffffffff;
+    newStream->cachedBlocks[i].lastUse = 0;
+    newStream->cachedBlocks[i].dirty = FALSE;
+  }
+  newStream->blockCacheUse           = 0;
 
   if (FAILED(BlockChainStream_UpdateIndexCache(newStream)))
   {
@@ -7294,7 +7359,7 @@ HRESULT BlockChainStream_Flush(BlockChainStream* This)
 {
   int i;
   if (!This) return S_OK;
-  for (i=0; i<2; i++)
+  for (i=0; i<BLOCKCHAIN_BLOCK_CACHE_SIZE; i++)
   {
     if (This->cachedBlocks[i].dirty)
     {
@@ -7398,7 +7463,7 @@ static BOOL BlockChainStream_Shrink(BlockChainStream* This,
   /*
    * Reset the last accessed block cache.
    */
-  for (i=0; i<2; i++)
+  for (i=0; i<BLOCKCHAIN_BLOCK_CACHE_SIZE; i++)
   {
     if (This->cachedBlocks[i].index >= numBlocks)
     {
@@ -7654,7 +7719,18 @@ HRESULT BlockChainStream_ReadAt(BlockChainStream* This,
 
     if (!cachedBlock)
     {
-      /* Not in cache, and we're going to read past the end of the block. */
+      /* Not in cache, and we're going to read past the end of the block.
+       * Read all following blocks that are contiguous on disk at once,
+       * leaving the last one to the cache. */
+      ULONG blockCount = BlockChainStream_GetContiguousBlocks(This, blockNoInSequence,
+          (size - bytesToReadInBuffer + This->parentStorage->bigBlockSize - 1) / This->parentStorage->bigBlockSize);
+
+      if (blockCount > 1)
+      {
+        bytesToReadInBuffer += (blockCount - 1) * This->parentStorage->bigBlockSize;
+        blockNoInSequence += blockCount - 1;
+      }
+
       ulOffset.QuadPart = StorageImpl_GetBigBlockOffset(This->parentStorage, blockIndex) +
                                offsetInBlock;
 
@@ -7738,7 +7814,18 @@ HRESULT BlockChainStream_WriteAt(BlockChainStream* This,
 
     if (!cachedBlock)
     {
-      /* Not in cache, and we're going to write past the end of the block. */
+      /* Not in cache, and we're going to write past the end of the block.
+       * Write all following blocks that are contiguous on disk at once,
+       * leaving the last one to the cache. */
+      ULONG blockCount = BlockChainStream_GetContiguousBlocks(This, blockNoInSequence,
+          (size - bytesToWrite + This->parentStorage->bigBlockSize - 1) / This->parentStorage->bigBlockSize);
+
+      if (blockCount > 1)
+      {
+        bytesToWrite += (blockCount - 1) * This->parentStorage->bigBlockSize;
+        blockNoInSequence += blockCount - 1;
+      }
+
       ulOffset.QuadPart = StorageImpl_GetBigBlockOffset(This->parentStorage, blockIndex) +
                                offsetInBlock;
 
@@ -5497,6 +5497,17 @@ static void test_SetFuncAndParamNames(void)
 
     ICreateTypeInfo_Release(cti);
 
+    hr = ICreateTypeLib2_QueryInterface(ctl, &IID_ITypeLib, (void**)&tl);
+    ok(hr == S_OK, "got %08x\n", hr);
+
+    found = 3;
+    memset(infos, 0, sizeof(infos));
+    hr = ITypeLib_FindName(tl, func, 0, infos, memids, &found);
+    ok(hr == S_OK, "got %08x\n", hr);
+    ok(found == 1, "got wrong count: %u\n", found);
+    ok(infos[0] && !infos[1], "got wrong typeinfo\n");
+    ITypeInfo_Release(infos[0]);
+
     hr = ICreateTypeLib2_CreateTypeInfo(ctl, name2W, TKIND_INTERFACE, &cti);
     ok(hr == S_OK, "got %08x\n", hr);
 
@@ -5512,9 +5523,6 @@ static void test_SetFuncAndParamNames(void)
 
     ICreateTypeInfo_Release(cti);
 
-    hr = ICreateTypeLib2_QueryInterface(ctl, &IID_ITypeLib, (void**)&tl);
-    ok(hr == S_OK, "got %08x\n", hr);
-
     found = 1;
     memset(infos, 0, sizeof(infos));
     memids[0] = 0xdeadbeef;
@@ -5702,6 +5710,7 @@ static void test_FindName(void)
     MEMBERID memid;
     ITypeInfo *ti;
     ITypeLib *tl;
+    BOOL isname;
     HRESULT hr;
     UINT16 c;
 
@@ -5764,6 +5773,33 @@ todo_wine {
     ok(c == 0, "got %d\n", c);
     ok(ti == (void*)0xdeadbeef, "got %p\n", ti);
 
+    c = 1;
+    memid = -1;
+    lstrcpyW(buffW, L"QueryInterface");
+    hr = ITypeLib_FindName(tl, buffW, 0, &ti, &memid, &c);
+    ok(hr == S_OK, "got 0x%08x\n", hr);
+    ok(memid == 0x60000000, "got %d\n", memid);
+    ok(c == 1, "got %d\n", c);
+    ITypeInfo_Release(ti);
+
+    isname = FALSE;
+    lstrcpyW(buffW, L"QueryInterface");
+    hr = ITypeLib_IsName(tl, buffW, 0, &isname);
+    ok(hr == S_OK, "got 0x%08x\n", hr);
+    ok(isname, "expected name to be found\n");
+
+    isname = FALSE;
+    lstrcpyW(buffW, wszGUID);
+    hr = ITypeLib_IsName(tl, buffW, 0, &isname);
+    ok(hr == S_OK, "got 0x%08x\n", hr);
+    ok(isname, "expected name to be found\n");
+
+    isname = TRUE;
+    lstrcpyW(buffW, invalidW);
+    hr = ITypeLib_IsName(tl, buffW, 0, &isname);
+    ok(hr == S_OK, "got 0x%08x\n", hr);
+    ok(!isname, "expected name not to be found\n");
+
     ITypeLib_Release(tl);
 }
 
@@ -1133,6 +1133,7 @@ typedef struct tagITypeLibImpl
 				   typelibs */
     struct list ref_list;       /* list of ref types in this typelib */
     HREFTYPE dispatch_href;     /* reference to IDispatch, -1 if unused */
+    struct tagTLBNameIndex *name_index; /* hashed type and member names, built on first lookup */
 
 
     /* typelibs are cached, keyed by path and index, so store the linked list info within them */
@@ -1318,7 +1319,7 @@ static inline BSTR TLB_get_bstr(const TLBString *str)
     return str != NULL ? str->str : NULL;
 }
 
-static inline int TLB_str_memcmp(void *left, const TLBString *str, DWORD len)
+static inline int TLB_str_memcmp(const void *left, const TLBString *str, DWORD len)
 {
     if(!str)
         return 1;
@@ -1762,6 +1763,194 @@ static inline ITypeInfoImpl *TLB_get_typeinfo_by_name(ITypeLibImpl *typelib, con
     return NULL;
 }
 
+/* Name lookups through IsName, FindName and GetIDsOfNames go through a hash
+ * table built on first use. Entries are added in typeinfo order, so walking
+ * a bucket visits matches in the same order as a linear scan would. */
+enum tlb_name_kind
+{
+    TLB_NAME_TYPE,
+    TLB_NAME_FUNC,
+    TLB_NAME_PARAM,
+    TLB_NAME_VAR
+};
+
+typedef struct tagTLBNameEntry
+{
+    struct list entry;
+    const TLBString *name;
+    ITypeInfoImpl *typeinfo;
+    enum tlb_name_kind kind;
+    UINT index;                 /* function or variable index in typeinfo */
+    UINT hash;
+} TLBNameEntry;
+
+typedef struct tagTLBNameIndex
+{
+    UINT bucket_count;          /* 0 if some names can't be hashed */
+    struct list *buckets;
+    TLBNameEntry entries[1];
+} TLBNameIndex;
+
+/* lstrcmpiW may consider strings with non-alphanumeric characters equal even
+ * if they differ, so only plain identifiers get a case insensitive hash. */
+static BOOL TLB_hash_name(const OLECHAR *name, UINT *hash)
+{
+    UINT h = 0;
+
+    if (!name)
+        return FALSE;
+
+    for (; *name; name++)
+    {
+        OLECHAR c = *name;
+
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+              (c >= '0' && c <= '9') || c == '_'))
+            return FALSE;
+        h = h * 31 + (c | 0x20);
+    }
+
+    *hash = h;
+    return TRUE;
+}
+
+static BOOL TLB_add_name_entry(TLBNameIndex *index, UINT *count, const TLBString *name,
+        ITypeInfoImpl *typeinfo, enum tlb_name_kind kind, UINT member)
+{
+    TLBNameEntry *entry;
+    UINT hash;
+
+    if (!name)
+        return TRUE;
+    if (!TLB_hash_name(name->str, &hash))
+        return FALSE;
+
+    entry = &index->entries[(*count)++];
+    entry->name = name;
+    entry->typeinfo = typeinfo;
+    entry->kind = kind;
+    entry->index = member;
+    entry->hash = hash;
+    list_add_tail(&index->buckets[hash & (index->bucket_count - 1)], &entry->entry);
+    return TRUE;
+}
+
+static TLBNameIndex *TLB_build_name_index(ITypeLibImpl *typelib)
+{
+    TLBNameIndex *index;
+    UINT count = 0, bucket_count = 16, i, j, k;
+
+    for (i = 0; i < typelib->TypeInfoCount; ++i)
+    {
+        ITypeInfoImpl *typeinfo = typelib->typeinfos[i];
+
+        count += 1 + typeinfo->typeattr.cFuncs + typeinfo->typeattr.cVars;
+        for (j = 0; j < typeinfo->typeattr.cFuncs; ++j)
+            count += typeinfo->funcdescs[j].funcdesc.cParams;
+    }
+    while (bucket_count < count)
+        bucket_count *= 2;
+
+    index = heap_alloc(FIELD_OFFSET(TLBNameIndex, entries[count]) + bucket_count * sizeof(struct list));
+    if (!index)
+        return NULL;
+    index->bucket_count = bucket_count;
+    index->buckets = (struct list *)&index->entries[count];
+    for (i = 0; i < bucket_count; ++i)
+        list_init(&index->buckets[i]);
+
+    count = 0;
+    for (i = 0; i < typelib->TypeInfoCount; ++i)
+    {
+        ITypeInfoImpl *typeinfo = typelib->typeinfos[i];
+
+        if (!TLB_add_name_entry(index, &count, typeinfo->Name, typeinfo, TLB_NAME_TYPE, 0))
+            goto unhashable;
+        for (j = 0; j < typeinfo->typeattr.cFuncs; ++j)
+        {
+            TLBFuncDesc *func = &typeinfo->funcdescs[j];
+
+            if (!TLB_add_name_entry(index, &count, func->Name, typeinfo, TLB_NAME_FUNC, j))
+                goto unhashable;
+            for (k = 0; k < func->funcdesc.cParams; ++k)
+                if (!TLB_add_name_entry(index, &count, func->pParamDesc[k].Name, typeinfo, TLB_NAME_PARAM, j))
+                    goto unhashable;
+        }
+        for (j = 0; j < typeinfo->typeattr.cVars; ++j)
+            if (!TLB_add_name_entry(index, &count, typeinfo->vardescs[j].Name, typeinfo, TLB_NAME_VAR, j))
+                goto unhashable;
+    }
+
+    TRACE("%p: indexed %u names in %u buckets\n", typelib, count, bucket_count);
+    return index;
+
+unhashable:
+    TRACE("%p: not indexing names\n", typelib);
+    heap_free(index);
+    return heap_alloc_zero(sizeof(TLBNameIndex));
+}
+
+/* Returns the bucket to search for name, or NULL if a linear scan is needed. */
+static const struct list *TLB_get_name_bucket(ITypeLibImpl *typelib, const OLECHAR *name, UINT *hash)
+{
+    TLBNameIndex *index, *old;
+
+    if (!TLB_hash_name(name, hash))
+        return NULL;
+
+    if (!(index = typelib->name_index))
+    {
+        if (!(index = TLB_build_name_index(typelib)))
+            return NULL;
+        if ((old = InterlockedCompareExchangePointer((void **)&typelib->name_index, index, NULL)))
+        {
+            heap_free(index);
+            index = old;
+        }
+    }
+
+    if (!index->bucket_count)
+        return NULL;
+    return &index->buckets[*hash & (index->bucket_count - 1)];
+}
+
+/* Looks up the function called name in typeinfo, or the variable if there is
+ * no such function. Returns FALSE if the name index can't be used. */
+static BOOL TLB_find_member_by_name(ITypeInfoImpl *typeinfo, const OLECHAR *name,
+        const TLBFuncDesc **func, const TLBVarDesc **var)
+{
+    const struct list *bucket;
+    const TLBNameEntry *entry;
+    UINT hash;
+
+    if (!typeinfo->pTypeLib || !(bucket = TLB_get_name_bucket(typeinfo->pTypeLib, name, &hash)))
+        return FALSE;
+
+    LIST_FOR_EACH_ENTRY(entry, bucket, TLBNameEntry, entry)
+    {
+        if (entry->hash != hash || lstrcmpiW(TLB_get_bstr(entry->name), name))
+            continue;
+
+        /* the dual interface copy of a typeinfo shares its member arrays */
+        if (entry->kind == TLB_NAME_FUNC && entry->typeinfo->funcdescs == typeinfo->funcdescs)
+        {
+            *func = &typeinfo->funcdescs[entry->index];
+            *var = NULL;
+            return TRUE;
+        }
+        if (entry->kind == TLB_NAME_VAR && !*var && entry->typeinfo->vardescs == typeinfo->vardescs)
+            *var = &typeinfo->vardescs[entry->index];
+    }
+
+    return TRUE;
+}
+
+static void TLB_invalidate_name_index(ITypeLibImpl *typelib)
+{
+    heap_free(typelib->name_index);
+    typelib->name_index = NULL;
+}
+
 static void TLBVarDesc_Constructor(TLBVarDesc *var_desc)
 {
     list_init(&var_desc->custdata_list);
@@ -4810,6 +4999,7 @@ static ULONG WINAPI ITypeLib2_fnRelease( ITypeLib2 *iface)
           ITypeInfoImpl_Destroy(This->typeinfos[i]);
       }
       heap_free(This->typeinfos);
+      heap_free(This->name_index);
       heap_free(This);
       return 0;
     }
@@ -5056,12 +5246,25 @@ static HRESULT WINAPI ITypeLib2_fnIsName(
 {
     ITypeLibImpl *This = impl_from_ITypeLib2(iface);
     int tic;
-    UINT nNameBufLen = (lstrlenW(szNameBuf)+1)*sizeof(WCHAR), fdc, vrc;
+    UINT nNameBufLen = (lstrlenW(szNameBuf)+1)*sizeof(WCHAR), fdc, vrc, hash;
+    const struct list *bucket;
+    const TLBNameEntry *entry;
 
     TRACE("(%p)->(%s,%08x,%p)\n", This, debugstr_w(szNameBuf), lHashVal,
 	  pfName);
 
     *pfName=TRUE;
+    if ((bucket = TLB_get_name_bucket(This, szNameBuf, &hash)))
+    {
+        LIST_FOR_EACH_ENTRY(entry, bucket, TLBNameEntry, entry)
+        {
+            if (entry->hash == hash && !TLB_str_memcmp(szNameBuf, entry->name, nNameBufLen))
+                goto ITypeLib2_fnIsName_exit;
+        }
+        *pfName = FALSE;
+        goto ITypeLib2_fnIsName_exit;
+    }
+
     for(tic = 0; tic < This->TypeInfoCount; ++tic){
         ITypeInfoImpl *pTInfo = This->typeinfos[tic];
         if(!TLB_str_memcmp(szNameBuf, pTInfo->Name, nNameBufLen)) goto ITypeLib2_fnIsName_exit;
@@ -5083,12 +5286,55 @@ static HRESULT WINAPI ITypeLib2_fnIsName(
     *pfName=FALSE;
 
 ITypeLib2_fnIsName_exit:
-    TRACE("(%p)slow! search for %s: %sfound!\n", This,
+    TRACE("(%p) search for %s: %sfound!\n", This,
           debugstr_w(szNameBuf), *pfName ? "" : "NOT ");
 
     return S_OK;
 }
 
+static UINT TLB_find_name_in_bucket(const struct list *bucket, UINT name_hash, const OLECHAR *name,
+        UINT len, ITypeInfo **ppTInfo, MEMBERID *memid, UINT16 found)
+{
+    UINT count = 0;
+    const ITypeInfoImpl *last = NULL;
+    const TLBNameEntry *entry;
+
+    LIST_FOR_EACH_ENTRY(entry, bucket, TLBNameEntry, entry)
+    {
+        ITypeInfoImpl *pTInfo = entry->typeinfo;
+
+        if (count >= found)
+            break;
+        if (entry->hash != name_hash || pTInfo == last)
+            continue;
+
+        switch (entry->kind)
+        {
+        case TLB_NAME_TYPE:
+            if (TLB_str_memcmp(name, entry->name, len)) continue;
+            memid[count] = MEMBERID_NIL;
+            break;
+        case TLB_NAME_FUNC:
+            if (TLB_str_memcmp(name, entry->name, len)) continue;
+            memid[count] = pTInfo->funcdescs[entry->index].funcdesc.memid;
+            break;
+        case TLB_NAME_VAR:
+            if (lstrcmpiW(TLB_get_bstr(entry->name), name)) continue;
+            memid[count] = pTInfo->vardescs[entry->index].vardesc.memid;
+            break;
+        default:
+            continue;
+        }
+
+        last = pTInfo;
+        ITypeInfo2_AddRef(&pTInfo->ITypeInfo2_iface);
+        ppTInfo[count] = (ITypeInfo *)&pTInfo->ITypeInfo2_iface;
+        count++;
+    }
+
+    return count;
+}
+
 /* ITypeLib::FindName
  *
  * Finds occurrences of a type description in a type library. This may be used
@@ -5104,9 +5350,10 @@ static HRESULT WINAPI ITypeLib2_fnFindName(
 	UINT16 *found)
 {
     ITypeLibImpl *This = impl_from_ITypeLib2(iface);
+    const struct list *bucket;
     int tic;
     UINT count = 0;
-    UINT len;
+    UINT len, name_hash;
 
     TRACE("(%p)->(%s %u %p %p %p)\n", This, debugstr_w(name), hash, ppTInfo, memid, found);
 
@@ -5114,6 +5361,13 @@ static HRESULT WINAPI ITypeLib2_fnFindName(
         return E_INVALIDARG;
 
     len = (lstrlenW(name) + 1)*sizeof(WCHAR);
+    if ((bucket = TLB_get_name_bucket(This, name, &name_hash)))
+    {
+        *found = TLB_find_name_in_bucket(bucket, name_hash, name, len, ppTInfo, memid, *found);
+        TRACE("found %d typeinfos\n", *found);
+        return S_OK;
+    }
+
     for(tic = 0; count < *found && tic < This->TypeInfoCount; ++tic) {
         ITypeInfoImpl *pTInfo = This->typeinfos[tic];
         TLBVarDesc *var;
@@ -6273,7 +6527,8 @@ static HRESULT WINAPI ITypeInfo_fnGetIDsOfNames( ITypeInfo2 *iface,
         LPOLESTR  *rgszNames, UINT cNames, MEMBERID  *pMemId)
 {
     ITypeInfoImpl *This = impl_from_ITypeInfo2(iface);
-    const TLBVarDesc *pVDesc;
+    const TLBFuncDesc *pFDesc = NULL;
+    const TLBVarDesc *pVDesc = NULL;
     HRESULT ret=S_OK;
     UINT i, fdc;
 
@@ -6284,25 +6539,32 @@ static HRESULT WINAPI ITypeInfo_fnGetIDsOfNames( ITypeInfo2 *iface,
     for (i = 0; i < cNames; i++)
         pMemId[i] = MEMBERID_NIL;
 
-    for (fdc = 0; fdc < This->typeattr.cFuncs; ++fdc) {
-        int j;
-        const TLBFuncDesc *pFDesc = &This->funcdescs[fdc];
-        if(!lstrcmpiW(*rgszNames, TLB_get_bstr(pFDesc->Name))) {
-            if(cNames) *pMemId=pFDesc->funcdesc.memid;
-            for(i=1; i < cNames; i++){
-                for(j=0; j<pFDesc->funcdesc.cParams; j++)
-                    if(!lstrcmpiW(rgszNames[i],TLB_get_bstr(pFDesc->pParamDesc[j].Name)))
-                            break;
-                if( j<pFDesc->funcdesc.cParams)
-                    pMemId[i]=j;
-                else
-                   ret=DISP_E_UNKNOWNNAME;
-            };
-            TRACE("-- 0x%08x\n", ret);
-            return ret;
+    if (!TLB_find_member_by_name(This, *rgszNames, &pFDesc, &pVDesc)) {
+        for (fdc = 0; fdc < This->typeattr.cFuncs; ++fdc) {
+            if(!lstrcmpiW(*rgszNames, TLB_get_bstr(This->funcdescs[fdc].Name))) {
+                pFDesc = &This->funcdescs[fdc];
+                break;
+            }
         }
+        if (!pFDesc)
+            pVDesc = TLB_get_vardesc_by_name(This, *rgszNames);
+    }
+
+    if (pFDesc) {
+        int j;
+        if(cNames) *pMemId=pFDesc->funcdesc.memid;
+        for(i=1; i < cNames; i++){
+            for(j=0; j<pFDesc->funcdesc.cParams; j++)
+                if(!lstrcmpiW(rgszNames[i],TLB_get_bstr(pFDesc->pParamDesc[j].Name)))
+                        break;
+            if( j<pFDesc->funcdesc.cParams)
+                pMemId[i]=j;
+            else
+               ret=DISP_E_UNKNOWNNAME;
+        };
+        TRACE("-- 0x%08x\n", ret);
+        return ret;
     }
-    pVDesc = TLB_get_vardesc_by_name(This, *rgszNames);
     if(pVDesc){
         if(cNames)
             *pMemId = pVDesc->vardesc.memid;
@@ -9112,6 +9374,7 @@ static HRESULT WINAPI ICreateTypeLib2_fnCreateTypeInfo(ICreateTypeLib2 *iface,
     info->hreftype = info->index * sizeof(MSFT_TypeInfoBase);
 
     ++This->TypeInfoCount;
+    TLB_invalidate_name_index(This);
 
     return S_OK;
 }
@@ -10882,6 +11145,7 @@ static HRESULT WINAPI ICreateTypeInfo2_fnAddFuncDesc(ICreateTypeInfo2 *iface,
     list_init(&func_desc->custdata_list);
 
     ++This->typeattr.cFuncs;
+    TLB_invalidate_name_index(This->pTypeLib);
 
     This->needs_layout = TRUE;
 
@@ -11038,6 +11302,7 @@ static HRESULT WINAPI ICreateTypeInfo2_fnAddVarDesc(ICreateTypeInfo2 *iface,
     var_desc->vardesc = *var_desc->vardesc_create;
 
     ++This->typeattr.cVars;
+    TLB_invalidate_name_index(This->pTypeLib);
 
     This->needs_layout = TRUE;
 
@@ -11084,6 +11349,8 @@ static HRESULT WINAPI ICreateTypeInfo2_fnSetFuncAndParamNames(ICreateTypeInfo2 *
         par_desc->Name = TLB_append_str(&This->pTypeLib->name_list, *(names + i));
     }
 
+    TLB_invalidate_name_index(This->pTypeLib);
+
     return S_OK;
 }
 
@@ -11101,6 +11368,7 @@ static HRESULT WINAPI ICreateTypeInfo2_fnSetVarName(ICreateTypeInfo2 *iface,
         return TYPE_E_ELEMENTNOTFOUND;
 
     This->vardescs[index].Name = TLB_append_str(&This->pTypeLib->name_list, name);
+    TLB_invalidate_name_index(This->pTypeLib);
     return S_OK;
 }
 
@@ -11516,6 +11784,7 @@ static HRESULT WINAPI ICreateTypeInfo2_fnSetName(ICreateTypeInfo2 *iface,
         return E_INVALIDARG;
 
     This->Name = TLB_append_str(&This->pTypeLib->name_list, name);
+    TLB_invalidate_name_index(This->pTypeLib);
 
     return S_OK;
 }
@@ -235,6 +235,8 @@ struct async_call_data
     unsigned short stack_size;
     /* number of parameters. optional for client to give it to us */
     unsigned int number_of_params;
+    /* buffer size needed by the params that don't have to be sized */
+    unsigned short buffer_size;
     /* location to put retval into */
     LONG_PTR *retval_ptr;
     /* correlation cache */
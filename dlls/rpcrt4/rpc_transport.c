@@ -68,6 +68,10 @@ typedef struct _RpcConnection_np
     IO_STATUS_BLOCK io_status;
     HANDLE event_cache;
     BOOL read_closed;
+    char *read_buf;
+    unsigned int read_buf_pos;
+    unsigned int read_buf_len;
+    BOOL read_buf_partial;
 } RpcConnection_np;
 
 static RpcConnection *rpcrt4_conn_np_alloc(void)
@@ -372,9 +376,8 @@ static RPC_STATUS rpcrt4_ncalrpc_handoff(RpcConnection *old_conn, RpcConnection
   return status;
 }
 
-static int rpcrt4_conn_np_read(RpcConnection *conn, void *buffer, unsigned int count)
+static int rpcrt4_conn_np_read_pipe(RpcConnection_np *connection, void *buffer, unsigned int count)
 {
-    RpcConnection_np *connection = (RpcConnection_np *) conn;
     HANDLE event;
     NTSTATUS status;
 
@@ -401,6 +404,44 @@ static int rpcrt4_conn_np_read(RpcConnection *conn, void *buffer, unsigned int c
     return status && status != STATUS_BUFFER_OVERFLOW ? -1 : connection->io_status.Information;
 }
 
+static int rpcrt4_conn_np_read(RpcConnection *conn, void *buffer, unsigned int count)
+{
+    RpcConnection_np *connection = (RpcConnection_np *) conn;
+    unsigned int copied;
+    int ret;
+
+    /* Packets are read piecewise (common header, rest of the header, body), so
+     * read whole messages into a buffer to need only one pipe read per packet. */
+    if (connection->read_buf_pos == connection->read_buf_len && count && count < RPC_MAX_PACKET_SIZE)
+    {
+        if (!connection->read_buf &&
+            !(connection->read_buf = HeapAlloc(GetProcessHeap(), 0, RPC_MAX_PACKET_SIZE)))
+            return -1;
+
+        ret = rpcrt4_conn_np_read_pipe(connection, connection->read_buf, RPC_MAX_PACKET_SIZE);
+        if (ret <= 0)
+            return ret;
+
+        connection->read_buf_pos = 0;
+        connection->read_buf_len = ret;
+        connection->read_buf_partial = connection->io_status.Status == STATUS_BUFFER_OVERFLOW;
+    }
+
+    copied = min(count, connection->read_buf_len - connection->read_buf_pos);
+    if (copied || connection->read_buf_pos != connection->read_buf_len)
+    {
+        memcpy(buffer, connection->read_buf + connection->read_buf_pos, copied);
+        connection->read_buf_pos += copied;
+
+        /* stop at the end of the message, unless it didn't fit in the buffer */
+        if (copied == count || !connection->read_buf_partial)
+            return copied;
+    }
+
+    ret = rpcrt4_conn_np_read_pipe(connection, (char *)buffer + copied, count - copied);
+    return ret < 0 ? -1 : copied + ret;
+}
+
 static int rpcrt4_conn_np_write(RpcConnection *conn, const void *buffer, unsigned int count)
 {
     RpcConnection_np *connection = (RpcConnection_np *) conn;
@@ -445,6 +486,9 @@ static int rpcrt4_conn_np_close(RpcConnection *conn)
         CloseHandle(connection->event_cache);
         connection->event_cache = 0;
     }
+    HeapFree(GetProcessHeap(), 0, connection->read_buf);
+    connection->read_buf = NULL;
+    connection->read_buf_pos = connection->read_buf_len = 0;
     return 0;
 }
 
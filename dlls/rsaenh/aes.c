@@ -926,6 +926,78 @@ static const ulong32 rcon[] = {
     0x1B000000UL, 0x36000000UL
 };
 
+#if defined(__x86_64__) && defined(__GNUC__)
+
+static int have_aesni(void)
+{
+    static int aesni = -1;
+    unsigned int a, b, c, d;
+
+    if (aesni == -1) {
+        __asm__ ("cpuid" : "=a" (a), "=b" (b), "=c" (c), "=d" (d) : "a" (1), "c" (0));
+        aesni = (c >> 25) & 1;
+    }
+    return aesni;
+}
+
+static void aesni_setup(aes_key *skey)
+{
+    ulong32 temp;
+    int i;
+
+    for (i = 0; i < (skey->Nr + 1) * 4; i++) {
+        temp = skey->eK[i];
+        STORE32H(temp, (unsigned char *)&skey->eK[i]);
+        temp = skey->dK[i];
+        STORE32H(temp, (unsigned char *)&skey->dK[i]);
+    }
+    skey->aesni = 1;
+}
+
+static void aesni_encrypt(const unsigned char *pt, unsigned char *ct, const ulong32 *rk, int Nr)
+{
+    int rounds = Nr - 1;
+
+    __asm__ __volatile__ (
+        "movdqu (%[rk]), %%xmm1\n\t"
+        "movdqu (%[pt]), %%xmm0\n\t"
+        "pxor %%xmm1, %%xmm0\n"
+        "1:\tadd $16, %[rk]\n\t"
+        "movdqu (%[rk]), %%xmm1\n\t"
+        "aesenc %%xmm1, %%xmm0\n\t"
+        "dec %[nr]\n\t"
+        "jnz 1b\n\t"
+        "movdqu 16(%[rk]), %%xmm1\n\t"
+        "aesenclast %%xmm1, %%xmm0\n\t"
+        "movdqu %%xmm0, (%[ct])\n\t"
+        : [rk] "+r" (rk), [nr] "+r" (rounds)
+        : [pt] "r" (pt), [ct] "r" (ct)
+        : "xmm0", "xmm1", "memory", "cc" );
+}
+
+static void aesni_decrypt(const unsigned char *ct, unsigned char *pt, const ulong32 *rk, int Nr)
+{
+    int rounds = Nr - 1;
+
+    __asm__ __volatile__ (
+        "movdqu (%[rk]), %%xmm1\n\t"
+        "movdqu (%[ct]), %%xmm0\n\t"
+        "pxor %%xmm1, %%xmm0\n"
+        "1:\tadd $16, %[rk]\n\t"
+        "movdqu (%[rk]), %%xmm1\n\t"
+        "aesdec %%xmm1, %%xmm0\n\t"
+        "dec %[nr]\n\t"
+        "jnz 1b\n\t"
+        "movdqu 16(%[rk]), %%xmm1\n\t"
+        "aesdeclast %%xmm1, %%xmm0\n\t"
+        "movdqu %%xmm0, (%[pt])\n\t"
+        : [rk] "+r" (rk), [nr] "+r" (rounds)
+        : [ct] "r" (ct), [pt] "r" (pt)
+        : "xmm0", "xmm1", "memory", "cc" );
+}
+
+#endif
+
 static ulong32 setup_mix(ulong32 temp)
 {
    return (Te4_3[byte(temp, 2)]) ^
@@ -949,6 +1021,7 @@ int aes_setup(const unsigned char *key, int keylen, int rounds, aes_key *skey)
     }
 
     skey->Nr = 10 + ((keylen/8)-2)*2;
+    skey->aesni = 0;
 
     /* setup the forward key */
     i                 = 0;
@@ -1058,6 +1131,10 @@ int aes_setup(const unsigned char *key, int keylen, int rounds, aes_key *skey)
     *rk++ = *rrk++;
     *rk   = *rrk;
 
+#if defined(__x86_64__) && defined(__GNUC__)
+    if (have_aesni()) aesni_setup(skey);
+#endif
+
     return CRYPT_OK;
 }
 
@@ -1069,6 +1146,13 @@ void aes_ecb_encrypt(const unsigned char *pt, unsigned char *ct, aes_key *skey)
     Nr = skey->Nr;
     rk = skey->eK;
 
+#if defined(__x86_64__) && defined(__GNUC__)
+    if (skey->aesni) {
+        aesni_encrypt(pt, ct, rk, Nr);
+        return;
+    }
+#endif
+
     LOAD32H(s0, pt      ); s0 ^= rk[0];
     LOAD32H(s1, pt  +  4); s1 ^= rk[1];
     LOAD32H(s2, pt  +  8); s2 ^= rk[2];
@@ -1170,6 +1254,13 @@ void aes_ecb_decrypt(const unsigned char *ct, unsigned char *pt, aes_key *skey)
     Nr = skey->Nr;
     rk = skey->dK;
 
+#if defined(__x86_64__) && defined(__GNUC__)
+    if (skey->aesni) {
+        aesni_decrypt(ct, pt, rk, Nr);
+        return;
+    }
+#endif
+
     LOAD32H(s0, ct      ); s0 ^= rk[0];
     LOAD32H(s1, ct  +  4); s1 ^= rk[1];
     LOAD32H(s2, ct  +  8); s2 ^= rk[2];
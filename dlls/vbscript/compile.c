@@ -164,6 +164,7 @@ static unsigned push_instr(compile_ctx_t *ctx, vbsop_t op)
 
     ctx->code->instrs[ctx->instr_cnt].op = op;
     ctx->code->instrs[ctx->instr_cnt].loc = ctx->loc;
+    ctx->code->instrs[ctx->instr_cnt].ident_cache = 0;
     return ctx->instr_cnt++;
 }
 
@@ -126,10 +126,56 @@ static BOOL lookup_global_funcs(ScriptDisp *script, const WCHAR *name, ref_t *re
     return FALSE;
 }
 
+/*
+ * An instruction always looks up the same identifier, so once it's been resolved
+ * to a local variable, an argument or a global variable, we remember its index
+ * in the instruction and check that slot first on the next execution.
+ */
+#define IDENT_CACHE_VAR    1
+#define IDENT_CACHE_ARG    2
+#define IDENT_CACHE_GLOBAL 3
+
+#define IDENT_CACHE(type,idx)   (((idx) << 2) | (type))
+#define IDENT_CACHE_TYPE(cache) ((cache) & 3)
+#define IDENT_CACHE_IDX(cache)  ((cache) >> 2)
+
+static BOOL lookup_cached_identifier(exec_ctx_t *ctx, ScriptDisp *script_obj, const WCHAR *name, ref_t *ref)
+{
+    unsigned cache = ctx->instr->ident_cache, i = IDENT_CACHE_IDX(cache);
+    dynamic_var_t *var;
+
+    switch(IDENT_CACHE_TYPE(cache)) {
+    case IDENT_CACHE_VAR:
+        if(i >= ctx->func->var_cnt || wcsicmp(ctx->func->vars[i].name, name))
+            return FALSE;
+        ref->type = REF_VAR;
+        ref->u.v = ctx->vars+i;
+        return TRUE;
+    case IDENT_CACHE_ARG:
+        if(i >= ctx->func->arg_cnt || wcsicmp(ctx->func->args[i].name, name))
+            return FALSE;
+        ref->type = REF_VAR;
+        ref->u.v = ctx->args+i;
+        return TRUE;
+    case IDENT_CACHE_GLOBAL:
+        if(i >= script_obj->global_vars_cnt)
+            return FALSE;
+        var = script_obj->global_vars[i];
+        if(wcsicmp(var->name, name))
+            return FALSE;
+        ref->type = var->is_const ? REF_CONST : REF_VAR;
+        ref->u.v = &var->v;
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
 static HRESULT lookup_identifier(exec_ctx_t *ctx, BSTR name, vbdisp_invoke_type_t invoke_type, ref_t *ref)
 {
     ScriptDisp *script_obj = ctx->script->script_obj;
     named_item_t *item;
+    BOOL cache_globals;
     unsigned i;
     DISPID id;
     HRESULT hres;
@@ -141,20 +187,31 @@ static HRESULT lookup_identifier(exec_ctx_t *ctx, BSTR name, vbdisp_invoke_type_
         return S_OK;
     }
 
+    /* Global variables are only looked up first if there is nothing that could shadow them. */
+    cache_globals = !ctx->code->named_item && !ctx->func->code_ctx->named_item && !ctx->vbthis;
+
     if(ctx->func->type != FUNC_GLOBAL) {
-        for(i=0; i < ctx->func->var_cnt; i++) {
-            if(!wcsicmp(ctx->func->vars[i].name, name)) {
-                ref->type = REF_VAR;
-                ref->u.v = ctx->vars+i;
-                return TRUE;
+        /* Local variables and arguments don't change, so they can't shadow a cached global. */
+        if(IDENT_CACHE_TYPE(ctx->instr->ident_cache) != IDENT_CACHE_GLOBAL) {
+            if(lookup_cached_identifier(ctx, script_obj, name, ref))
+                return S_OK;
+
+            for(i=0; i < ctx->func->var_cnt; i++) {
+                if(!wcsicmp(ctx->func->vars[i].name, name)) {
+                    ref->type = REF_VAR;
+                    ref->u.v = ctx->vars+i;
+                    ctx->instr->ident_cache = IDENT_CACHE(IDENT_CACHE_VAR, i);
+                    return TRUE;
+                }
             }
-        }
 
-        for(i=0; i < ctx->func->arg_cnt; i++) {
-            if(!wcsicmp(ctx->func->args[i].name, name)) {
-                ref->type = REF_VAR;
-                ref->u.v = ctx->args+i;
-                return S_OK;
+            for(i=0; i < ctx->func->arg_cnt; i++) {
+                if(!wcsicmp(ctx->func->args[i].name, name)) {
+                    ref->type = REF_VAR;
+                    ref->u.v = ctx->args+i;
+                    ctx->instr->ident_cache = IDENT_CACHE(IDENT_CACHE_ARG, i);
+                    return S_OK;
+                }
             }
         }
 
@@ -200,8 +257,21 @@ static HRESULT lookup_identifier(exec_ctx_t *ctx, BSTR name, vbdisp_invoke_type_
         }
     }
 
-    if(lookup_global_vars(script_obj, name, ref))
+    if(cache_globals && IDENT_CACHE_TYPE(ctx->instr->ident_cache) == IDENT_CACHE_GLOBAL
+       && lookup_cached_identifier(ctx, script_obj, name, ref))
         return S_OK;
+
+    for(i = 0; i < script_obj->global_vars_cnt; i++) {
+        dynamic_var_t *var = script_obj->global_vars[i];
+
+        if(!wcsicmp(var->name, name)) {
+            ref->type = var->is_const ? REF_CONST : REF_VAR;
+            ref->u.v = &var->v;
+            if(cache_globals)
+                ctx->instr->ident_cache = IDENT_CACHE(IDENT_CACHE_GLOBAL, i);
+            return S_OK;
+        }
+    }
     if(lookup_global_funcs(script_obj, name, ref))
         return S_OK;
 
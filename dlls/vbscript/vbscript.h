@@ -299,6 +299,7 @@ typedef struct {
     unsigned loc;
     instr_arg_t arg1;
     instr_arg_t arg2;
+    unsigned ident_cache;
 } instr_t;
 
 typedef struct {
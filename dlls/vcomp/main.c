@@ -42,6 +42,7 @@ static HMODULE vcomp_module;
 static int     vcomp_max_threads;
 static int     vcomp_num_threads;
 static BOOL    vcomp_nested_fork = FALSE;
+static unsigned int vcomp_spin_count;
 
 static RTL_CRITICAL_SECTION vcomp_section;
 static RTL_CRITICAL_SECTION_DEBUG critsect_debug =
@@ -95,7 +96,7 @@ struct vcomp_team_data
 
     /* barrier */
     unsigned int            barrier;
-    int                     barrier_count;
+    LONG                    barrier_count;
 };
 
 struct vcomp_task_data
@@ -115,6 +116,8 @@ struct vcomp_task_data
     unsigned int            dynamic_iterations;
     int                     dynamic_step;
     unsigned int            dynamic_chunksize;
+    /* generation in the high and remaining iterations in the low 32 bits */
+    LONG64                  dynamic_state;
 };
 
 #if defined(__i386__)
@@ -395,6 +398,7 @@ static struct vcomp_thread_data *vcomp_init_thread_data(void)
     data->task.single           = 0;
     data->task.section          = 0;
     data->task.dynamic          = 0;
+    data->task.dynamic_state    = 0;
 
     thread_data = &data->thread;
     thread_data->team           = NULL;
@@ -1038,28 +1042,52 @@ void CDECL _vcomp_flush(void)
     TRACE("(): stub\n");
 }
 
+static inline void vcomp_pause(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+    __asm__ __volatile__( "rep;nop" : : : "memory" );
+#else
+    __asm__ __volatile__( "" : : : "memory" );
+#endif
+}
+
 void CDECL _vcomp_barrier(void)
 {
     struct vcomp_team_data *team_data = vcomp_init_thread_data()->team;
+    unsigned int barrier, i;
 
     TRACE("()\n");
 
     if (!team_data)
         return;
 
-    EnterCriticalSection(&vcomp_section);
-    if (++team_data->barrier_count >= team_data->num_threads)
+    barrier = team_data->barrier;
+    if (InterlockedIncrement(&team_data->barrier_count) >= team_data->num_threads)
     {
+        InterlockedExchange(&team_data->barrier_count, 0);
+        EnterCriticalSection(&vcomp_section);
         team_data->barrier++;
-        team_data->barrier_count = 0;
         WakeAllConditionVariable(&team_data->cond);
+        LeaveCriticalSection(&vcomp_section);
+        return;
     }
-    else
+
+    /* the other threads usually arrive soon, so spin for a while before sleeping */
+    for (i = 0; i < vcomp_spin_count; i++)
     {
-        unsigned int barrier = team_data->barrier;
-        while (team_data->barrier == barrier)
-            SleepConditionVariableCS(&team_data->cond, &vcomp_section, INFINITE);
+        if (*(volatile unsigned int *)&team_data->barrier != barrier)
+        {
+            /* the interlocked read orders our following reads after the
+             * writes the other threads made before reaching the barrier */
+            InterlockedCompareExchange((LONG *)&team_data->barrier, 0, 0);
+            return;
+        }
+        vcomp_pause();
     }
+
+    EnterCriticalSection(&vcomp_section);
+    while (team_data->barrier == barrier)
+        SleepConditionVariableCS(&team_data->cond, &vcomp_section, INFINITE);
     LeaveCriticalSection(&vcomp_section);
 }
 
@@ -1275,6 +1303,7 @@ void CDECL _vcomp_for_dynamic_init(unsigned int flags, unsigned int first, unsig
                                    int step, unsigned int chunksize)
 {
     unsigned int iterations, per_thread, remaining;
+    LONG64 state, prev, old;
     struct vcomp_thread_data *thread_data = vcomp_init_thread_data();
     struct vcomp_team_data *team_data = thread_data->team;
     struct vcomp_task_data *task_data = thread_data->task;
@@ -1337,6 +1366,10 @@ void CDECL _vcomp_for_dynamic_init(unsigned int flags, unsigned int first, unsig
             task_data->dynamic_iterations   = iterations;
             task_data->dynamic_step         = step;
             task_data->dynamic_chunksize    = chunksize;
+            state = ((LONG64)task_data->dynamic << 32) | iterations;
+            prev  = task_data->dynamic_state;
+            while ((old = InterlockedCompareExchange64(&task_data->dynamic_state, state, prev)) != prev)
+                prev = old;
         }
         LeaveCriticalSection(&vcomp_section);
     }
@@ -1361,26 +1394,45 @@ int CDECL _vcomp_for_dynamic_next(unsigned int *begin, unsigned int *end)
     else if (thread_data->dynamic_type == VCOMP_DYNAMIC_FLAGS_CHUNKED ||
              thread_data->dynamic_type == VCOMP_DYNAMIC_FLAGS_GUIDED)
     {
-        unsigned int iterations = 0;
-        EnterCriticalSection(&vcomp_section);
-        if (thread_data->dynamic == task_data->dynamic &&
-            task_data->dynamic_iterations != 0)
+        unsigned int first, last, total, chunksize, remaining, iterations;
+        LONG64 state, prev;
+        int step;
+
+        /* Grab the next chunk without taking the lock. The loop parameters can't
+         * change before all iterations of the current loop have been handed out,
+         * which would make the compare-exchange fail. */
+        state = InterlockedCompareExchange64(&task_data->dynamic_state, 0, 0);
+        for (;;)
         {
-            iterations = min(task_data->dynamic_iterations, task_data->dynamic_chunksize);
+            remaining = (unsigned int)state;
+            if ((unsigned int)(state >> 32) != thread_data->dynamic || !remaining)
+                return 0;
+
+            first       = task_data->dynamic_first;
+            last        = task_data->dynamic_last;
+            total       = task_data->dynamic_iterations;
+            step        = task_data->dynamic_step;
+            chunksize   = task_data->dynamic_chunksize;
+
+            iterations = min(remaining, chunksize);
             if (thread_data->dynamic_type == VCOMP_DYNAMIC_FLAGS_GUIDED &&
-                task_data->dynamic_iterations > num_threads * task_data->dynamic_chunksize)
+                remaining > num_threads * chunksize)
             {
-                iterations = (task_data->dynamic_iterations + num_threads - 1) / num_threads;
+                iterations = (remaining + num_threads - 1) / num_threads;
             }
-            *begin = task_data->dynamic_first;
-            *end   = task_data->dynamic_first + (iterations - 1) * task_data->dynamic_step;
-            task_data->dynamic_iterations -= iterations;
-            task_data->dynamic_first      += iterations * task_data->dynamic_step;
-            if (!task_data->dynamic_iterations)
-                *end = task_data->dynamic_last;
+            if (!iterations)
+                return 0;
+
+            prev = InterlockedCompareExchange64(&task_data->dynamic_state, state - iterations, state);
+            if (prev == state) break;
+            state = prev;
         }
-        LeaveCriticalSection(&vcomp_section);
-        return iterations != 0;
+
+        *begin = first + (total - remaining) * step;
+        *end   = *begin + (iterations - 1) * step;
+        if (iterations == remaining)
+            *end = last;
+        return 1;
     }
 
     return 0;
@@ -1465,6 +1517,7 @@ void WINAPIV _vcomp_fork(BOOL ifval, int nargs, void *wrapper, ...)
     task_data.single            = 0;
     task_data.section           = 0;
     task_data.dynamic           = 0;
+    task_data.dynamic_state     = 0;
 
     thread_data.team            = &team_data;
     thread_data.task            = &task_data;
@@ -1680,6 +1733,7 @@ BOOL WINAPI DllMain(HINSTANCE instance, DWORD reason, LPVOID reserved)
             vcomp_module      = instance;
             vcomp_max_threads = sysinfo.dwNumberOfProcessors;
             vcomp_num_threads = sysinfo.dwNumberOfProcessors;
+            vcomp_spin_count  = sysinfo.dwNumberOfProcessors > 1 ? 4000 : 0;
             break;
         }
 
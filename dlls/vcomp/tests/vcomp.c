@@ -593,6 +593,43 @@ static void test_vcomp_fork(void)
     pomp_set_num_threads(max_threads);
 }
 
+static void CDECL barrier_cb(int *slots, LONG *failures)
+{
+    int num_threads = pomp_get_num_threads();
+    int thread_num = pomp_get_thread_num();
+    int round, i;
+
+    for (round = 1; round <= 50; round++)
+    {
+        slots[thread_num] = round * 64 + thread_num;
+        p_vcomp_barrier();
+
+        for (i = 0; i < num_threads; i++)
+            if (slots[i] != round * 64 + i) InterlockedIncrement(failures);
+        p_vcomp_barrier();
+    }
+}
+
+static void test_vcomp_barrier(void)
+{
+    int max_threads = pomp_get_max_threads();
+    int slots[64];
+    LONG failures;
+    int i;
+
+    for (i = 1; i <= 64; i *= 2)
+    {
+        pomp_set_num_threads(i);
+
+        memset(slots, 0, sizeof(slots));
+        failures = 0;
+        p_vcomp_fork(TRUE, 2, barrier_cb, slots, &failures);
+        ok(!failures, "%d threads: got %d failures\n", i, failures);
+    }
+
+    pomp_set_num_threads(max_threads);
+}
+
 static void CDECL section_cb(LONG *a, LONG *b, LONG *c)
 {
     int i;
@@ -1258,6 +1295,18 @@ static void test_vcomp_for_dynamic_init(void)
         ok(d == 14790, "expected d == 14790, got %d\n", d);
     }
 
+    for (i = 8; i <= 64; i *= 2)
+    {
+        pomp_set_num_threads(i);
+
+        a = b = c = d = 0;
+        p_vcomp_fork(TRUE, 4, for_dynamic_chunked_cb, &a, &b, &c, &d);
+        ok(a == 71071, "expected a == 71071, got %d\n", a);
+        ok(b == 71929, "expected b == 71929, got %d\n", b);
+        ok(c == 14210, "expected c == 14210, got %d\n", c);
+        ok(d == 14790, "expected d == 14790, got %d\n", d);
+    }
+
     /* test guided scheduling */
     a = b = c = d = 0;
     for_dynamic_guided_cb(VCOMP_DYNAMIC_FLAGS_GUIDED, &a, &b, &c, &d);
@@ -2217,6 +2266,7 @@ START_TEST(vcomp)
     test_omp_get_num_threads(FALSE);
     test_omp_get_num_threads(TRUE);
     test_vcomp_fork();
+    test_vcomp_barrier();
     test_vcomp_sections_init();
     test_vcomp_for_static_simple_init();
     test_vcomp_for_static_init();
@@ -19,6 +19,7 @@
 
 #include "config.h"
 
+#include <assert.h>
 #include <stdarg.h>
 #include <math.h>
 
@@ -138,6 +139,167 @@ static inline FormatConverter *impl_from_IWICFormatConverter(IWICFormatConverter
     return CONTAINING_RECORD(iface, FormatConverter, IWICFormatConverter_iface);
 }
 
+/* Exact value of c * a / 255 rounded down, for c, a <= 255. */
+static inline BYTE premultiply_component(BYTE c, BYTE a)
+{
+    UINT t = c * a;
+    return (t + (t >> 8) + 1) >> 8;
+}
+
+static void premultiply_32bpp(BYTE *buffer, UINT width, UINT height, UINT stride)
+{
+    UINT x, y;
+
+    for (y = 0; y < height; y++)
+    {
+        BYTE *pixel = buffer + stride * y;
+
+        for (x = 0; x < width; x++, pixel += 4)
+        {
+            BYTE alpha = pixel[3];
+
+            if (alpha == 255) continue;
+            pixel[0] = premultiply_component(pixel[0], alpha);
+            pixel[1] = premultiply_component(pixel[1], alpha);
+            pixel[2] = premultiply_component(pixel[2], alpha);
+        }
+    }
+}
+
+static void unpremultiply_32bpp(BYTE *buffer, UINT width, UINT height, UINT stride)
+{
+    UINT x, y;
+
+    for (y = 0; y < height; y++)
+    {
+        BYTE *pixel = buffer + stride * y;
+
+        for (x = 0; x < width; x++, pixel += 4)
+        {
+            BYTE alpha = pixel[3];
+
+            if (alpha == 0 || alpha == 255) continue;
+            pixel[0] = pixel[0] * 255 / alpha;
+            pixel[1] = pixel[1] * 255 / alpha;
+            pixel[2] = pixel[2] * 255 / alpha;
+        }
+    }
+}
+
+static void set_alpha_32bpp(BYTE *buffer, UINT width, UINT height, UINT stride)
+{
+    UINT x, y;
+
+    for (y = 0; y < height; y++)
+    {
+        BYTE *pixel = buffer + stride * y + 3;
+
+        for (x = 0; x < width; x++, pixel += 4)
+            *pixel = 0xff;
+    }
+}
+
+/* Expands 8bpp gray or 24bpp pixels already stored at the start of each
+ * row of a 32bpp buffer. Rows are processed from the end so that no source
+ * pixel is overwritten before it is read. */
+static void expand_to_32bppBGRA(BYTE *buffer, UINT width, UINT height, UINT stride,
+    enum pixelformat format)
+{
+    UINT x, y;
+
+    for (y = 0; y < height; y++)
+    {
+        BYTE *row = buffer + stride * y;
+        DWORD *dst = (DWORD *)row + width;
+
+        switch (format)
+        {
+        case format_8bppGray:
+            for (x = width; x--;)
+                *--dst = 0xff000000 | (row[x] << 16) | (row[x] << 8) | row[x];
+            break;
+        case format_24bppBGR:
+            for (x = width; x--;)
+                *--dst = 0xff000000 | (row[3 * x + 2] << 16) | (row[3 * x + 1] << 8) | row[3 * x];
+            break;
+        case format_24bppRGB:
+            for (x = width; x--;)
+                *--dst = 0xff000000 | (row[3 * x] << 16) | (row[3 * x + 1] << 8) | row[3 * x + 2];
+            break;
+        default:
+            assert(0);
+        }
+    }
+}
+
+/* Packs 32bpp pixels into 24bpp, optionally swapping the red and blue
+ * channels. The source and destination may be the same buffer as long as
+ * src_stride is not smaller than dst_stride. */
+static void pack_32bpp_to_24bpp(const BYTE *src, UINT src_stride, BYTE *dst, UINT dst_stride,
+    UINT width, UINT height, BOOL swap)
+{
+    UINT x, y;
+
+    for (y = 0; y < height; y++)
+    {
+        const BYTE *srcpixel = src + src_stride * y;
+        BYTE *dstpixel = dst + dst_stride * y;
+
+        if (swap)
+        {
+            for (x = 0; x < width; x++, srcpixel += 4, dstpixel += 3)
+            {
+                BYTE b = srcpixel[0], g = srcpixel[1], r = srcpixel[2];
+                dstpixel[0] = r;
+                dstpixel[1] = g;
+                dstpixel[2] = b;
+            }
+        }
+        else
+        {
+            for (x = 0; x < width; x++, srcpixel += 4, dstpixel += 3)
+            {
+                BYTE b = srcpixel[0], g = srcpixel[1], r = srcpixel[2];
+                dstpixel[0] = b;
+                dstpixel[1] = g;
+                dstpixel[2] = r;
+            }
+        }
+    }
+}
+
+static HRESULT copypixels_32bpp_to_24bpp(struct FormatConverter *This, const WICRect *prc,
+    UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer, BOOL swap)
+{
+    UINT srcstride, srcdatasize;
+    BYTE *srcdata;
+    HRESULT hr;
+
+    srcstride = 4 * prc->Width;
+
+    /* Convert in place when the destination buffer can hold the source rows. */
+    if (cbStride >= srcstride && (UINT64)cbStride * prc->Height <= cbBufferSize)
+    {
+        hr = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
+        if (SUCCEEDED(hr))
+            pack_32bpp_to_24bpp(pbBuffer, cbStride, pbBuffer, cbStride, prc->Width, prc->Height, swap);
+        return hr;
+    }
+
+    srcdatasize = srcstride * prc->Height;
+
+    srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
+    if (!srcdata) return E_OUTOFMEMORY;
+
+    hr = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+    if (SUCCEEDED(hr))
+        pack_32bpp_to_24bpp(srcdata, srcstride, pbBuffer, cbStride, prc->Width, prc->Height, swap);
+
+    HeapFree(GetProcessHeap(), 0, srcdata);
+
+    return hr;
+}
+
 static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRect *prc,
     UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer, enum pixelformat source_format)
 {
@@ -335,43 +497,17 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
         }
         return S_OK;
     case format_8bppGray:
+    case format_24bppBGR:
+    case format_24bppRGB:
         if (prc)
         {
             HRESULT res;
-            INT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcbyte;
-            BYTE *dstrow;
-            DWORD *dstpixel;
-
-            srcstride = prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
 
+            /* The source pixels are smaller than the destination ones, so read
+             * them straight into the output rows and expand them there. */
+            res = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
             if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcbyte = srcrow;
-                    dstpixel=(DWORD*)dstrow;
-                    for (x=0; x<prc->Width; x++)
-                    {
-                        *dstpixel++ = 0xff000000|(*srcbyte<<16)|(*srcbyte<<8)|*srcbyte;
-                        srcbyte++;
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
+                expand_to_32bppBGRA(pbBuffer, prc->Width, prc->Height, cbStride, source_format);
 
             return res;
         }
@@ -616,138 +752,32 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
             return res;
         }
         return S_OK;
-    case format_24bppBGR:
-        if (prc)
-        {
-            HRESULT res;
-            INT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcpixel;
-            BYTE *dstrow;
-            BYTE *dstpixel;
-
-            srcstride = 3 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        *dstpixel++=*srcpixel++; /* blue */
-                        *dstpixel++=*srcpixel++; /* green */
-                        *dstpixel++=*srcpixel++; /* red */
-                        *dstpixel++=255; /* alpha */
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return res;
-        }
-        return S_OK;
-    case format_24bppRGB:
-        if (prc)
-        {
-            HRESULT res;
-            INT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcpixel;
-            BYTE *dstrow;
-            BYTE *dstpixel;
-            BYTE tmppixel[3];
-
-            srcstride = 3 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        tmppixel[0]=*srcpixel++; /* red */
-                        tmppixel[1]=*srcpixel++; /* green */
-                        tmppixel[2]=*srcpixel++; /* blue */
-
-                        *dstpixel++=tmppixel[2]; /* blue */
-                        *dstpixel++=tmppixel[1]; /* green */
-                        *dstpixel++=tmppixel[0]; /* red */
-                        *dstpixel++=255; /* alpha */
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return res;
-        }
-        return S_OK;
     case format_32bppBGR:
+    case format_32bppRGB:
+    case format_32bppRGBA:
+    case format_32bppPBGRA:
+    case format_32bppPRGBA:
         if (prc)
         {
             HRESULT res;
-            INT x, y;
 
             res = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
             if (FAILED(res)) return res;
 
-            /* set all alpha values to 255 */
-            for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                    pbBuffer[cbStride*y+4*x+3] = 0xff;
+            if (source_format == format_32bppBGR || source_format == format_32bppRGB)
+                set_alpha_32bpp(pbBuffer, prc->Width, prc->Height, cbStride);
+            else if (source_format == format_32bppPBGRA || source_format == format_32bppPRGBA)
+                unpremultiply_32bpp(pbBuffer, prc->Width, prc->Height, cbStride);
+
+            if (source_format == format_32bppRGB || source_format == format_32bppRGBA ||
+                source_format == format_32bppPRGBA)
+                reverse_bgr8(4, pbBuffer, prc->Width, prc->Height, cbStride);
         }
         return S_OK;
     case format_32bppBGRA:
         if (prc)
             return IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
         return S_OK;
-    case format_32bppPBGRA:
-        if (prc)
-        {
-            HRESULT res;
-            INT x, y;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
-            if (FAILED(res)) return res;
-
-            for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                {
-                    BYTE alpha = pbBuffer[cbStride*y+4*x+3];
-                    if (alpha != 0 && alpha != 255)
-                    {
-                        pbBuffer[cbStride*y+4*x] = pbBuffer[cbStride*y+4*x] * 255 / alpha;
-                        pbBuffer[cbStride*y+4*x+1] = pbBuffer[cbStride*y+4*x+1] * 255 / alpha;
-                        pbBuffer[cbStride*y+4*x+2] = pbBuffer[cbStride*y+4*x+2] * 255 / alpha;
-                    }
-                }
-        }
-        return S_OK;
     case format_48bppRGB:
         if (prc)
         {
@@ -873,15 +903,10 @@ static HRESULT copypixels_to_32bppRGBA(struct FormatConverter *This, const WICRe
     case format_32bppRGB:
         if (prc)
         {
-            INT x, y;
-
             hr = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
             if (FAILED(hr)) return hr;
 
-            /* set all alpha values to 255 */
-            for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                    pbBuffer[cbStride*y+4*x+3] = 0xff;
+            set_alpha_32bpp(pbBuffer, prc->Width, prc->Height, cbStride);
         }
         return S_OK;
 
@@ -893,22 +918,10 @@ static HRESULT copypixels_to_32bppRGBA(struct FormatConverter *This, const WICRe
     case format_32bppPRGBA:
         if (prc)
         {
-            INT x, y;
-
             hr = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
             if (FAILED(hr)) return hr;
 
-            for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                {
-                    BYTE alpha = pbBuffer[cbStride*y+4*x+3];
-                    if (alpha != 0 && alpha != 255)
-                    {
-                        pbBuffer[cbStride*y+4*x] = pbBuffer[cbStride*y+4*x] * 255 / alpha;
-                        pbBuffer[cbStride*y+4*x+1] = pbBuffer[cbStride*y+4*x+1] * 255 / alpha;
-                        pbBuffer[cbStride*y+4*x+2] = pbBuffer[cbStride*y+4*x+2] * 255 / alpha;
-                    }
-                }
+            unpremultiply_32bpp(pbBuffer, prc->Width, prc->Height, cbStride);
         }
         return S_OK;
 
@@ -966,21 +979,7 @@ static HRESULT copypixels_to_32bppPBGRA(struct FormatConverter *This, const WICR
     default:
         hr = copypixels_to_32bppBGRA(This, prc, cbStride, cbBufferSize, pbBuffer, source_format);
         if (SUCCEEDED(hr) && prc)
-        {
-            INT x, y;
-
-            for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                {
-                    BYTE alpha = pbBuffer[cbStride*y+4*x+3];
-                    if (alpha != 255)
-                    {
-                        pbBuffer[cbStride*y+4*x] = pbBuffer[cbStride*y+4*x] * alpha / 255;
-                        pbBuffer[cbStride*y+4*x+1] = pbBuffer[cbStride*y+4*x+1] * alpha / 255;
-                        pbBuffer[cbStride*y+4*x+2] = pbBuffer[cbStride*y+4*x+2] * alpha / 255;
-                    }
-                }
-        }
+            premultiply_32bpp(pbBuffer, prc->Width, prc->Height, cbStride);
         return hr;
     }
 }
@@ -999,21 +998,7 @@ static HRESULT copypixels_to_32bppPRGBA(struct FormatConverter *This, const WICR
     default:
         hr = copypixels_to_32bppRGBA(This, prc, cbStride, cbBufferSize, pbBuffer, source_format);
         if (SUCCEEDED(hr) && prc)
-        {
-            INT x, y;
-
-            for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                {
-                    BYTE alpha = pbBuffer[cbStride*y+4*x+3];
-                    if (alpha != 255)
-                    {
-                        pbBuffer[cbStride*y+4*x] = pbBuffer[cbStride*y+4*x] * alpha / 255;
-                        pbBuffer[cbStride*y+4*x+1] = pbBuffer[cbStride*y+4*x+1] * alpha / 255;
-                        pbBuffer[cbStride*y+4*x+2] = pbBuffer[cbStride*y+4*x+2] * alpha / 255;
-                    }
-                }
-        }
+            premultiply_32bpp(pbBuffer, prc->Width, prc->Height, cbStride);
         return hr;
     }
 }
@@ -1040,67 +1025,8 @@ static HRESULT copypixels_to_24bppBGR(struct FormatConverter *This, const WICRec
     case format_32bppPBGRA:
     case format_32bppRGBA:
         if (prc)
-        {
-            HRESULT res;
-            INT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcpixel;
-            BYTE *dstrow;
-            BYTE *dstpixel;
-
-            srcstride = 4 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-
-                if (source_format == format_32bppRGBA)
-                {
-                    for (y = 0; y < prc->Height; y++)
-                    {
-                        srcpixel = srcrow;
-                        dstpixel = dstrow;
-                        for (x = 0; x < prc->Width; x++) {
-                            *dstpixel++ = srcpixel[2]; /* blue */
-                            *dstpixel++ = srcpixel[1]; /* green */
-                            *dstpixel++ = srcpixel[0]; /* red */
-                            srcpixel += 4;
-                        }
-                        srcrow += srcstride;
-                        dstrow += cbStride;
-                    }
-                }
-                else
-                {
-                    for (y = 0; y < prc->Height; y++)
-                    {
-                        srcpixel = srcrow;
-                        dstpixel = dstrow;
-                        for (x = 0; x < prc->Width; x++) {
-                            *dstpixel++ = *srcpixel++; /* blue */
-                            *dstpixel++ = *srcpixel++; /* green */
-                            *dstpixel++ = *srcpixel++; /* red */
-                            srcpixel++; /* alpha */
-                        }
-                        srcrow += srcstride;
-                        dstrow += cbStride;
-                    }
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return res;
-        }
+            return copypixels_32bpp_to_24bpp(This, prc, cbStride, cbBufferSize, pbBuffer,
+                                             source_format == format_32bppRGBA);
         return S_OK;
 
     case format_32bppGrayFloat:
@@ -1214,51 +1140,7 @@ static HRESULT copypixels_to_24bppRGB(struct FormatConverter *This, const WICRec
     case format_32bppBGRA:
     case format_32bppPBGRA:
         if (prc)
-        {
-            HRESULT res;
-            INT x, y;
-            BYTE *srcdata;
-            UINT srcstride, srcdatasize;
-            const BYTE *srcrow;
-            const BYTE *srcpixel;
-            BYTE *dstrow;
-            BYTE *dstpixel;
-            BYTE tmppixel[3];
-
-            srcstride = 4 * prc->Width;
-            srcdatasize = srcstride * prc->Height;
-
-            srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
-            if (!srcdata) return E_OUTOFMEMORY;
-
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
-
-            if (SUCCEEDED(res))
-            {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
-                for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        tmppixel[0]=*srcpixel++; /* blue */
-                        tmppixel[1]=*srcpixel++; /* green */
-                        tmppixel[2]=*srcpixel++; /* red */
-                        srcpixel++; /* alpha */
-
-                        *dstpixel++=tmppixel[2]; /* red */
-                        *dstpixel++=tmppixel[1]; /* green */
-                        *dstpixel++=tmppixel[0]; /* blue */
-                    }
-                    srcrow += srcstride;
-                    dstrow += cbStride;
-                }
-            }
-
-            HeapFree(GetProcessHeap(), 0, srcdata);
-
-            return res;
-        }
+            return copypixels_32bpp_to_24bpp(This, prc, cbStride, cbBufferSize, pbBuffer, TRUE);
         return S_OK;
     default:
         FIXME("Unimplemented conversion path!\n");
@@ -20,6 +20,7 @@
 #include "config.h"
 
 #include <stdarg.h>
+#include <math.h>
 
 #define COBJMACROS
 
@@ -33,6 +34,20 @@
 
 WINE_DEFAULT_DEBUG_CHANNEL(wincodecs);
 
+/* Filter weights are stored as fixed point numbers with this many fractional
+ * bits. The first pass keeps 8 fractional bits of the intermediate result. */
+#define FILTER_WEIGHT_BITS 14
+#define FILTER_WEIGHT_ONE (1 << FILTER_WEIGHT_BITS)
+#define FILTER_INTERMEDIATE_SHIFT (FILTER_WEIGHT_BITS - 8)
+#define FILTER_RESULT_SHIFT (FILTER_WEIGHT_BITS + 8)
+
+typedef struct ScalerFilter {
+    UINT *start;
+    UINT *count;
+    INT *weights; /* taps weights per destination pixel */
+    UINT taps;
+} ScalerFilter;
+
 typedef struct BitmapScaler {
     IWICBitmapScaler IWICBitmapScaler_iface;
     LONG ref;
@@ -42,8 +57,12 @@ typedef struct BitmapScaler {
     UINT src_width, src_height;
     WICBitmapInterpolationMode mode;
     UINT bpp;
+    UINT channel_bits; /* bits per channel of filtered formats */
     void (*fn_get_required_source_rect)(struct BitmapScaler*,UINT,UINT,WICRect*);
     void (*fn_copy_scanline)(struct BitmapScaler*,UINT,UINT,UINT,BYTE**,UINT,UINT,BYTE*);
+    ScalerFilter filter_x, filter_y;
+    INT *filter_row;
+    UINT filter_row_size;
     CRITICAL_SECTION lock; /* must be held when initialized */
 } BitmapScaler;
 
@@ -57,6 +76,14 @@ static inline BitmapScaler *impl_from_IMILBitmapScaler(IMILBitmapScaler *iface)
     return CONTAINING_RECORD(iface, BitmapScaler, IMILBitmapScaler_iface);
 }
 
+static void free_filter(ScalerFilter *filter)
+{
+    HeapFree(GetProcessHeap(), 0, filter->start);
+    HeapFree(GetProcessHeap(), 0, filter->count);
+    HeapFree(GetProcessHeap(), 0, filter->weights);
+    memset(filter, 0, sizeof(*filter));
+}
+
 static HRESULT WINAPI BitmapScaler_QueryInterface(IWICBitmapScaler *iface, REFIID iid,
     void **ppv)
 {
@@ -108,6 +135,9 @@ static ULONG WINAPI BitmapScaler_Release(IWICBitmapScaler *iface)
         This->lock.DebugInfo->Spare[0] = 0;
         DeleteCriticalSection(&This->lock);
         if (This->source) IWICBitmapSource_Release(This->source);
+        free_filter(&This->filter_x);
+        free_filter(&This->filter_y);
+        HeapFree(GetProcessHeap(), 0, This->filter_row);
         HeapFree(GetProcessHeap(), 0, This);
     }
 
@@ -205,6 +235,333 @@ static void NearestNeighbor_CopyScanline(BitmapScaler *This,
     }
 }
 
+static double filter_triangle(double x)
+{
+    x = fabs(x);
+    return x < 1.0 ? 1.0 - x : 0.0;
+}
+
+/* Keys cubic convolution kernel with a = -0.5 (Catmull-Rom). */
+static double filter_cubic(double x)
+{
+    x = fabs(x);
+    if (x < 1.0)
+        return (1.5 * x - 2.5) * x * x + 1.0;
+    if (x < 2.0)
+        return ((-0.5 * x + 2.5) * x - 4.0) * x + 2.0;
+    return 0.0;
+}
+
+/* Compute, for every destination pixel along one axis, the range of source
+ * pixels it depends on and their fixed point weights. Source pixels beyond
+ * the edges are clamped to the edge pixel. */
+static HRESULT init_filter(ScalerFilter *filter, UINT src_size, UINT dst_size,
+    WICBitmapInterpolationMode mode)
+{
+    double (*kernel)(double) = filter_triangle;
+    double scale = (double)dst_size / src_size;
+    double radius = 1.0, kernel_scale = 1.0;
+    double *weights;
+    BOOL box = FALSE;
+    UINT i, j;
+
+    switch (mode)
+    {
+    case WICBitmapInterpolationModeLinear:
+        break;
+    case WICBitmapInterpolationModeCubic:
+        kernel = filter_cubic;
+        radius = 2.0;
+        break;
+    case WICBitmapInterpolationModeFant:
+        /* Area averaging when shrinking, linear when enlarging. */
+        if (scale < 1.0)
+        {
+            box = TRUE;
+            radius = 0.5 / scale + 1.0;
+        }
+        break;
+    case WICBitmapInterpolationModeHighQualityCubic:
+    default:
+        kernel = filter_cubic;
+        radius = 2.0;
+        if (scale < 1.0)
+        {
+            kernel_scale = scale;
+            radius /= scale;
+        }
+        break;
+    }
+
+    filter->taps = (UINT)ceil(radius * 2.0) + 1;
+    filter->start = HeapAlloc(GetProcessHeap(), 0, dst_size * sizeof(*filter->start));
+    filter->count = HeapAlloc(GetProcessHeap(), 0, dst_size * sizeof(*filter->count));
+    filter->weights = HeapAlloc(GetProcessHeap(), 0, dst_size * filter->taps * sizeof(*filter->weights));
+    weights = HeapAlloc(GetProcessHeap(), 0, filter->taps * sizeof(*weights));
+    if (!filter->start || !filter->count || !filter->weights || !weights)
+    {
+        HeapFree(GetProcessHeap(), 0, weights);
+        free_filter(filter);
+        return E_OUTOFMEMORY;
+    }
+
+    for (i = 0; i < dst_size; i++)
+    {
+        double centre = (i + 0.5) / scale - 0.5, total = 0.0;
+        INT first = (INT)floor(centre - radius) + 1, last = (INT)ceil(centre + radius) - 1;
+        INT lo = max(first, 0), hi = min(last, (INT)src_size - 1);
+        INT *out = filter->weights + i * filter->taps;
+        INT sum = 0, peak = 0;
+
+        if (lo > hi)
+            lo = hi = min(max((INT)floor(centre + 0.5), 0), (INT)src_size - 1);
+        if (hi - lo + 1 > filter->taps)
+            hi = lo + filter->taps - 1;
+
+        memset(weights, 0, filter->taps * sizeof(*weights));
+        for (j = 0; first + (INT)j <= last; j++)
+        {
+            INT x = first + j, idx = min(max(x, lo), hi) - lo;
+            double w;
+
+            if (box)
+            {
+                double l = max(x - 0.5, centre - 0.5 / scale), r = min(x + 0.5, centre + 0.5 / scale);
+                w = r > l ? r - l : 0.0;
+            }
+            else
+                w = kernel((x - centre) * kernel_scale);
+
+            weights[idx] += w;
+            total += w;
+        }
+
+        filter->start[i] = lo;
+        filter->count[i] = hi - lo + 1;
+
+        if (total == 0.0)
+        {
+            weights[0] = total = 1.0;
+        }
+
+        for (j = 0; j < filter->count[i]; j++)
+        {
+            out[j] = (INT)floor(weights[j] * FILTER_WEIGHT_ONE / total + 0.5);
+            sum += out[j];
+            if (out[j] > out[peak]) peak = j;
+        }
+        /* Make sure the weights add up to exactly one. */
+        out[peak] += FILTER_WEIGHT_ONE - sum;
+    }
+
+    HeapFree(GetProcessHeap(), 0, weights);
+    return S_OK;
+}
+
+static void Filter_GetRequiredSourceRect(BitmapScaler *This,
+    UINT x, UINT y, WICRect *src_rect)
+{
+    src_rect->X = This->filter_x.start[x];
+    src_rect->Y = This->filter_y.start[y];
+    src_rect->Width = This->filter_x.count[x];
+    src_rect->Height = This->filter_y.count[y];
+}
+
+static INT *get_filter_row(BitmapScaler *This, UINT size)
+{
+    INT *new_row;
+
+    if (This->filter_row_size >= size)
+        return This->filter_row;
+
+    if (This->filter_row)
+        new_row = HeapReAlloc(GetProcessHeap(), 0, This->filter_row, size * sizeof(INT));
+    else
+        new_row = HeapAlloc(GetProcessHeap(), 0, size * sizeof(INT));
+    if (!new_row)
+    {
+        ERR("failed to allocate intermediate row\n");
+        return NULL;
+    }
+    This->filter_row = new_row;
+    This->filter_row_size = size;
+    return new_row;
+}
+
+static inline BYTE filter_clamp(INT value)
+{
+    value = (value + (1 << (FILTER_RESULT_SHIFT - 1))) >> FILTER_RESULT_SHIFT;
+    return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+/* Filters vertically into an intermediate row covering the source columns
+ * available in src_data, then horizontally into the destination. */
+static void Filter_CopyScanline(BitmapScaler *This,
+    UINT dst_x, UINT dst_y, UINT dst_width,
+    BYTE **src_data, UINT src_data_x, UINT src_data_y, BYTE *pbBuffer)
+{
+    const ScalerFilter *fx = &This->filter_x, *fy = &This->filter_y;
+    UINT bytesperpixel = This->bpp / 8;
+    UINT src_first, src_count, row_size;
+    const INT *weights;
+    INT *row;
+    UINT i, j, k;
+
+    src_first = fx->start[dst_x];
+    src_count = fx->start[dst_x + dst_width - 1] + fx->count[dst_x + dst_width - 1] - src_first;
+    row_size = src_count * bytesperpixel;
+
+    if (!(row = get_filter_row(This, row_size)))
+    {
+        memset(pbBuffer, 0, dst_width * bytesperpixel);
+        return;
+    }
+
+    weights = fy->weights + dst_y * fy->taps;
+    for (k = 0; k < fy->count[dst_y]; k++)
+    {
+        const BYTE *src = src_data[fy->start[dst_y] + k - src_data_y] + (src_first - src_data_x) * bytesperpixel;
+        INT w = weights[k];
+
+        if (!k)
+        {
+            for (j = 0; j < row_size; j++)
+                row[j] = src[j] * w;
+        }
+        else
+        {
+            for (j = 0; j < row_size; j++)
+                row[j] += src[j] * w;
+        }
+    }
+    for (j = 0; j < row_size; j++)
+        row[j] = (row[j] + (1 << (FILTER_INTERMEDIATE_SHIFT - 1))) >> FILTER_INTERMEDIATE_SHIFT;
+
+    for (i = 0; i < dst_width; i++)
+    {
+        const INT *src = row + (fx->start[dst_x + i] - src_first) * bytesperpixel;
+        BYTE *dst = pbBuffer + i * bytesperpixel;
+
+        weights = fx->weights + (dst_x + i) * fx->taps;
+        for (j = 0; j < bytesperpixel; j++)
+        {
+            INT sum = 0;
+
+            for (k = 0; k < fx->count[dst_x + i]; k++)
+                sum += src[k * bytesperpixel + j] * weights[k];
+            dst[j] = filter_clamp(sum);
+        }
+    }
+}
+
+static inline WORD filter_clamp16(INT value)
+{
+    value = (value + (1 << (FILTER_WEIGHT_BITS - 1))) >> FILTER_WEIGHT_BITS;
+    return value < 0 ? 0 : (value > 0xffff ? 0xffff : value);
+}
+
+/* Same as Filter_CopyScanline for formats with 16 bits per channel. The
+ * intermediate row keeps no fractional bits, so that the sums fit in an INT. */
+static void Filter_CopyScanline16(BitmapScaler *This,
+    UINT dst_x, UINT dst_y, UINT dst_width,
+    BYTE **src_data, UINT src_data_x, UINT src_data_y, BYTE *pbBuffer)
+{
+    const ScalerFilter *fx = &This->filter_x, *fy = &This->filter_y;
+    UINT bytesperpixel = This->bpp / 8, channels = This->bpp / 16;
+    UINT src_first, src_count, row_size;
+    const INT *weights;
+    INT *row;
+    UINT i, j, k;
+
+    src_first = fx->start[dst_x];
+    src_count = fx->start[dst_x + dst_width - 1] + fx->count[dst_x + dst_width - 1] - src_first;
+    row_size = src_count * channels;
+
+    if (!(row = get_filter_row(This, row_size)))
+    {
+        memset(pbBuffer, 0, dst_width * bytesperpixel);
+        return;
+    }
+
+    weights = fy->weights + dst_y * fy->taps;
+    for (k = 0; k < fy->count[dst_y]; k++)
+    {
+        const WORD *src = (const WORD *)(src_data[fy->start[dst_y] + k - src_data_y] +
+                (src_first - src_data_x) * bytesperpixel);
+        INT w = weights[k];
+
+        if (!k)
+        {
+            for (j = 0; j < row_size; j++)
+                row[j] = src[j] * w;
+        }
+        else
+        {
+            for (j = 0; j < row_size; j++)
+                row[j] += src[j] * w;
+        }
+    }
+    for (j = 0; j < row_size; j++)
+        row[j] = (row[j] + (1 << (FILTER_WEIGHT_BITS - 1))) >> FILTER_WEIGHT_BITS;
+
+    for (i = 0; i < dst_width; i++)
+    {
+        const INT *src = row + (fx->start[dst_x + i] - src_first) * channels;
+        WORD *dst = (WORD *)(pbBuffer + i * bytesperpixel);
+
+        weights = fx->weights + (dst_x + i) * fx->taps;
+        for (j = 0; j < channels; j++)
+        {
+            INT sum = 0;
+
+            for (k = 0; k < fx->count[dst_x + i]; k++)
+                sum += src[k * channels + j] * weights[k];
+            dst[j] = filter_clamp16(sum);
+        }
+    }
+}
+
+/* Returns the number of bits per channel of formats whose channels can be
+ * filtered independently, or 0 for formats that can't be filtered. */
+static UINT get_filter_channel_bits(const WICPixelFormatGUID *format)
+{
+    static const WICPixelFormatGUID *formats8[] =
+    {
+        &GUID_WICPixelFormat8bppGray,
+        &GUID_WICPixelFormat8bppAlpha,
+        &GUID_WICPixelFormat24bppBGR,
+        &GUID_WICPixelFormat24bppRGB,
+        &GUID_WICPixelFormat32bppBGR,
+        &GUID_WICPixelFormat32bppBGRA,
+        &GUID_WICPixelFormat32bppPBGRA,
+        &GUID_WICPixelFormat32bppRGB,
+        &GUID_WICPixelFormat32bppRGBA,
+        &GUID_WICPixelFormat32bppPRGBA,
+        &GUID_WICPixelFormat32bppCMYK,
+    };
+    static const WICPixelFormatGUID *formats16[] =
+    {
+        &GUID_WICPixelFormat16bppGray,
+        &GUID_WICPixelFormat48bppRGB,
+        &GUID_WICPixelFormat48bppBGR,
+        &GUID_WICPixelFormat64bppRGB,
+        &GUID_WICPixelFormat64bppRGBA,
+        &GUID_WICPixelFormat64bppBGRA,
+        &GUID_WICPixelFormat64bppPRGBA,
+        &GUID_WICPixelFormat64bppPBGRA,
+        &GUID_WICPixelFormat64bppCMYK,
+    };
+    UINT i;
+
+    for (i = 0; i < ARRAY_SIZE(formats8); i++)
+        if (IsEqualGUID(format, formats8[i])) return 8;
+
+    for (i = 0; i < ARRAY_SIZE(formats16); i++)
+        if (IsEqualGUID(format, formats16[i])) return 16;
+
+    return 0;
+}
+
 static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
     const WICRect *prc, UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
 {
@@ -259,6 +616,12 @@ static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
         goto end;
     }
 
+    if (!dest_rect.Width || !dest_rect.Height)
+    {
+        hr = S_OK;
+        goto end;
+    }
+
     /* MSDN recommends calling CopyPixels once for each scanline from top to
      * bottom, and claims codecs optimize for this. Ideally, when called in this
      * way, we should avoid requesting a scanline from the source more than
@@ -321,6 +684,7 @@ static HRESULT WINAPI BitmapScaler_Initialize(IWICBitmapScaler *iface,
     BitmapScaler *This = impl_from_IWICBitmapScaler(iface);
     HRESULT hr;
     GUID src_pixelformat;
+    BOOL filter;
 
     TRACE("(%p,%p,%u,%u,%u)\n", iface, pISource, uiWidth, uiHeight, mode);
 
@@ -353,10 +717,46 @@ static HRESULT WINAPI BitmapScaler_Initialize(IWICBitmapScaler *iface,
     {
         switch (mode)
         {
+        case WICBitmapInterpolationModeLinear:
+        case WICBitmapInterpolationModeCubic:
+        case WICBitmapInterpolationModeFant:
+        case WICBitmapInterpolationModeHighQualityCubic:
+            filter = TRUE;
+            break;
         default:
             FIXME("unsupported mode %i\n", mode);
             /* fall-through */
         case WICBitmapInterpolationModeNearestNeighbor:
+            filter = FALSE;
+            break;
+        }
+
+        /* The output keeps the source format, so formats whose channels can't
+         * be filtered independently use nearest neighbor interpolation. */
+        if (filter && !(This->channel_bits = get_filter_channel_bits(&src_pixelformat)))
+        {
+            FIXME("interpolation of %s is not supported\n", debugstr_guid(&src_pixelformat));
+            filter = FALSE;
+        }
+
+        if (filter)
+        {
+            hr = init_filter(&This->filter_x, This->src_width, This->width, mode);
+            if (SUCCEEDED(hr))
+                hr = init_filter(&This->filter_y, This->src_height, This->height, mode);
+            if (FAILED(hr))
+            {
+                free_filter(&This->filter_x);
+                goto end;
+            }
+
+            IWICBitmapSource_AddRef(pISource);
+            This->source = pISource;
+            This->fn_get_required_source_rect = Filter_GetRequiredSourceRect;
+            This->fn_copy_scanline = This->channel_bits == 16 ? Filter_CopyScanline16 : Filter_CopyScanline;
+        }
+        else
+        {
             if ((This->bpp % 8) == 0)
             {
                 IWICBitmapSource_AddRef(pISource);
@@ -370,7 +770,6 @@ static HRESULT WINAPI BitmapScaler_Initialize(IWICBitmapScaler *iface,
             }
             This->fn_get_required_source_rect = NearestNeighbor_GetRequiredSourceRect;
             This->fn_copy_scanline = NearestNeighbor_CopyScanline;
-            break;
         }
     }
 
@@ -529,6 +928,11 @@ HRESULT BitmapScaler_Create(IWICBitmapScaler **scaler)
     This->src_height = 0;
     This->mode = 0;
     This->bpp = 0;
+    This->channel_bits = 0;
+    memset(&This->filter_x, 0, sizeof(This->filter_x));
+    memset(&This->filter_y, 0, sizeof(This->filter_y));
+    This->filter_row = NULL;
+    This->filter_row_size = 0;
     InitializeCriticalSection(&This->lock);
     This->lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": BitmapScaler.lock");
 
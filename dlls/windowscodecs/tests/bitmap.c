@@ -1318,6 +1318,192 @@ static LONG obj_refcount(void *obj)
     return IUnknown_Release((IUnknown *)obj);
 }
 
+static void test_bitmap_scaler_modes(void)
+{
+    static const WICBitmapInterpolationMode modes[] =
+    {
+        WICBitmapInterpolationModeLinear,
+        WICBitmapInterpolationModeCubic,
+        WICBitmapInterpolationModeFant,
+        WICBitmapInterpolationModeHighQualityCubic,
+    };
+    static const struct
+    {
+        const WICPixelFormatGUID *format;
+        UINT bpp;
+    }
+    formats[] =
+    {
+        { &GUID_WICPixelFormat8bppIndexed, 8 },
+        { &GUID_WICPixelFormat16bppGray, 16 },
+        { &GUID_WICPixelFormat48bppRGB, 48 },
+        { &GUID_WICPixelFormat64bppRGBA, 64 },
+    };
+    static const BYTE row[] = {0, 100, 200, 50};
+    static const BYTE ramp[] = {0, 200};
+    BYTE src[64], full[25], part[6], buf[16];
+    WORD src16[4 * 6 * 4], buf16[4 * 3 * 5];
+    IWICBitmapScaler *scaler;
+    WICPixelFormatGUID format;
+    IWICBitmap *bitmap;
+    WICRect rc;
+    HRESULT hr;
+    UINT i, j, k;
+
+    memset(src, 0x80, sizeof(src));
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 6, 4, &GUID_WICPixelFormat8bppGray,
+            6, 24, src, &bitmap);
+    ok(hr == S_OK, "Failed to create a bitmap, hr %#x.\n", hr);
+
+    for (i = 0; i < ARRAY_SIZE(modes); i++)
+    {
+        hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+        ok(hr == S_OK, "Failed to create bitmap scaler, hr %#x.\n", hr);
+
+        hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, 3, 5, modes[i]);
+        if (hr == E_INVALIDARG && modes[i] == WICBitmapInterpolationModeHighQualityCubic)
+        {
+            win_skip("High quality cubic interpolation is not supported.\n");
+            IWICBitmapScaler_Release(scaler);
+            continue;
+        }
+        ok(hr == S_OK, "Mode %u: failed to initialize bitmap scaler, hr %#x.\n", modes[i], hr);
+
+        memset(buf, 0, sizeof(buf));
+        hr = IWICBitmapScaler_CopyPixels(scaler, NULL, 3, 15, buf);
+        ok(hr == S_OK, "Mode %u: failed to copy pixels, hr %#x.\n", modes[i], hr);
+        for (j = 0; j < 15; j++)
+            ok(buf[j] == 0x80, "Mode %u: unexpected value %#x at %u.\n", modes[i], buf[j], j);
+
+        IWICBitmapScaler_Release(scaler);
+    }
+    IWICBitmap_Release(bitmap);
+
+    /* The scaler keeps the source format, and 16-bit channels keep their depth. */
+    for (i = 0; i < ARRAY_SIZE(src16); i++)
+        src16[i] = 0x1234;
+    for (k = 0; k < ARRAY_SIZE(formats); k++)
+    {
+        UINT stride = 6 * formats[k].bpp / 8;
+
+        hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 6, 4, formats[k].format,
+                stride, stride * 4, (BYTE *)src16, &bitmap);
+        ok(hr == S_OK, "Failed to create a bitmap, hr %#x.\n", hr);
+
+        for (i = 0; i < ARRAY_SIZE(modes); i++)
+        {
+            hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+            ok(hr == S_OK, "Failed to create bitmap scaler, hr %#x.\n", hr);
+
+            hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, 3, 5, modes[i]);
+            if (hr == E_INVALIDARG && modes[i] == WICBitmapInterpolationModeHighQualityCubic)
+            {
+                IWICBitmapScaler_Release(scaler);
+                continue;
+            }
+            ok(hr == S_OK, "Mode %u: failed to initialize bitmap scaler, hr %#x.\n", modes[i], hr);
+
+            hr = IWICBitmapScaler_GetPixelFormat(scaler, &format);
+            ok(hr == S_OK, "Mode %u: failed to get pixel format, hr %#x.\n", modes[i], hr);
+            ok(IsEqualGUID(&format, formats[k].format), "Mode %u: unexpected pixel format %s, expected %s.\n",
+                    modes[i], wine_dbgstr_guid(&format), wine_dbgstr_guid(formats[k].format));
+
+            if (formats[k].bpp > 8)
+            {
+                UINT count = 3 * 5 * formats[k].bpp / 16;
+
+                memset(buf16, 0, sizeof(buf16));
+                hr = IWICBitmapScaler_CopyPixels(scaler, NULL, 3 * formats[k].bpp / 8, count * 2,
+                        (BYTE *)buf16);
+                ok(hr == S_OK, "Mode %u: failed to copy pixels, hr %#x.\n", modes[i], hr);
+                for (j = 0; j < count; j++)
+                    ok(buf16[j] == 0x1234, "Mode %u, format %s: unexpected value %#x at %u.\n",
+                            modes[i], wine_dbgstr_guid(formats[k].format), buf16[j], j);
+            }
+
+            IWICBitmapScaler_Release(scaler);
+        }
+        IWICBitmap_Release(bitmap);
+    }
+
+    /* Fant averages the source pixels when shrinking. */
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 4, 1, &GUID_WICPixelFormat8bppGray,
+            4, 4, (BYTE *)row, &bitmap);
+    ok(hr == S_OK, "Failed to create a bitmap, hr %#x.\n", hr);
+    hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+    ok(hr == S_OK, "Failed to create bitmap scaler, hr %#x.\n", hr);
+    hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, 2, 1,
+            WICBitmapInterpolationModeFant);
+    ok(hr == S_OK, "Failed to initialize bitmap scaler, hr %#x.\n", hr);
+    memset(buf, 0, sizeof(buf));
+    hr = IWICBitmapScaler_CopyPixels(scaler, NULL, 2, 2, buf);
+    ok(hr == S_OK, "Failed to copy pixels, hr %#x.\n", hr);
+    ok(abs(buf[0] - 50) <= 1, "Unexpected value %u.\n", buf[0]);
+    ok(abs(buf[1] - 125) <= 1, "Unexpected value %u.\n", buf[1]);
+    IWICBitmapScaler_Release(scaler);
+    IWICBitmap_Release(bitmap);
+
+    /* Linear enlargement produces a monotonic ramp between the end points. */
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 2, 1, &GUID_WICPixelFormat8bppGray,
+            2, 2, (BYTE *)ramp, &bitmap);
+    ok(hr == S_OK, "Failed to create a bitmap, hr %#x.\n", hr);
+    hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+    ok(hr == S_OK, "Failed to create bitmap scaler, hr %#x.\n", hr);
+    hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, 8, 1,
+            WICBitmapInterpolationModeLinear);
+    ok(hr == S_OK, "Failed to initialize bitmap scaler, hr %#x.\n", hr);
+    memset(buf, 0, sizeof(buf));
+    hr = IWICBitmapScaler_CopyPixels(scaler, NULL, 8, 8, buf);
+    ok(hr == S_OK, "Failed to copy pixels, hr %#x.\n", hr);
+    ok(buf[0] < 100 && buf[7] > 100, "Unexpected end points %u, %u.\n", buf[0], buf[7]);
+    for (i = 1; i < 8; i++)
+        ok(buf[i] >= buf[i - 1], "Unexpected value %u at %u, previous %u.\n", buf[i], i, buf[i - 1]);
+    ok(buf[3] > buf[0] && buf[3] < buf[7], "Unexpected middle value %u.\n", buf[3]);
+    IWICBitmapScaler_Release(scaler);
+    IWICBitmap_Release(bitmap);
+
+    /* Copying a part of the image gives the same result as copying all of it. */
+    for (i = 0; i < sizeof(src); i++)
+        src[i] = (i % 8) * 30 + (i / 8) * 5;
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 8, 8, &GUID_WICPixelFormat8bppGray,
+            8, 64, src, &bitmap);
+    ok(hr == S_OK, "Failed to create a bitmap, hr %#x.\n", hr);
+    hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+    ok(hr == S_OK, "Failed to create bitmap scaler, hr %#x.\n", hr);
+    hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, 5, 5,
+            WICBitmapInterpolationModeCubic);
+    ok(hr == S_OK, "Failed to initialize bitmap scaler, hr %#x.\n", hr);
+    hr = IWICBitmapScaler_CopyPixels(scaler, NULL, 5, sizeof(full), full);
+    ok(hr == S_OK, "Failed to copy pixels, hr %#x.\n", hr);
+    rc.X = 1;
+    rc.Y = 2;
+    rc.Width = 3;
+    rc.Height = 2;
+    hr = IWICBitmapScaler_CopyPixels(scaler, &rc, 3, sizeof(part), part);
+    ok(hr == S_OK, "Failed to copy pixels, hr %#x.\n", hr);
+    for (i = 0; i < 2; i++)
+        for (j = 0; j < 3; j++)
+            ok(part[i * 3 + j] == full[(i + 2) * 5 + j + 1], "Unexpected value %u at (%u,%u), expected %u.\n",
+                    part[i * 3 + j], j, i, full[(i + 2) * 5 + j + 1]);
+
+    /* Empty rectangles copy nothing. */
+    rc.X = 4;
+    rc.Y = 4;
+    rc.Width = 0;
+    rc.Height = 1;
+    memset(part, 0xcc, sizeof(part));
+    hr = IWICBitmapScaler_CopyPixels(scaler, &rc, 3, sizeof(part), part);
+    ok(hr == S_OK, "Failed to copy pixels, hr %#x.\n", hr);
+    rc.Width = 1;
+    rc.Height = 0;
+    hr = IWICBitmapScaler_CopyPixels(scaler, &rc, 3, sizeof(part), part);
+    ok(hr == S_OK, "Failed to copy pixels, hr %#x.\n", hr);
+    for (i = 0; i < sizeof(part); i++)
+        ok(part[i] == 0xcc, "Unexpected value %u at %u.\n", part[i], i);
+    IWICBitmapScaler_Release(scaler);
+    IWICBitmap_Release(bitmap);
+}
+
 static void test_IMILBitmap(void)
 {
     HRESULT hr;
@@ -1482,6 +1668,7 @@ START_TEST(bitmap)
     test_CreateBitmapFromHBITMAP();
     test_clipper();
     test_bitmap_scaler();
+    test_bitmap_scaler_modes();
 
     IWICImagingFactory_Release(factory);
 
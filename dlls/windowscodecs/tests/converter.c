@@ -326,8 +326,8 @@ static BOOL is_indexed_format(const GUID *format)
 static void compare_bitmap_data(const struct bitmap_data *src, const struct bitmap_data *expect,
                                 IWICBitmapSource *source, const char *name)
 {
-    BYTE *converted_bits;
-    UINT width, height;
+    BYTE *converted_bits, *padded_bits;
+    UINT width, height, i;
     double xres, yres;
     WICRect prc;
     UINT stride, buffersize;
@@ -376,6 +376,17 @@ static void compare_bitmap_data(const struct bitmap_data *src, const struct bitm
     if (!(!is_indexed_format(src->format) && is_indexed_format(expect->format)))
         ok(compare_bits(expect, buffersize, converted_bits), "unexpected pixel data (%s)\n", name);
 
+    /* Test with rows larger than needed */
+    padded_bits = HeapAlloc(GetProcessHeap(), 0, buffersize * 2);
+    memset(padded_bits, 0xaa, buffersize * 2);
+    hr = IWICBitmapSource_CopyPixels(source, &prc, stride * 2, buffersize * 2, padded_bits);
+    ok(SUCCEEDED(hr), "CopyPixels(%s,padded) failed, hr=%x\n", name, hr);
+    for (i = 0; i < expect->height; i++)
+        memcpy(converted_bits + i * stride, padded_bits + i * stride * 2, stride);
+    if (!(!is_indexed_format(src->format) && is_indexed_format(expect->format)))
+        ok(compare_bits(expect, buffersize, converted_bits), "unexpected pixel data (%s,padded)\n", name);
+    HeapFree(GetProcessHeap(), 0, padded_bits);
+
     HeapFree(GetProcessHeap(), 0, converted_bits);
 }
 
@@ -1866,6 +1877,9 @@ START_TEST(converter)
     test_conversion(&testdata_32bppRGB, &testdata_32bppRGBA, "RGB -> RGBA", FALSE);
     test_conversion(&testdata_32bppRGBA, &testdata_32bppRGBA, "RGBA -> RGBA", FALSE);
     test_conversion(&testdata_32bppRGBA80, &testdata_32bppPRGBA, "RGBA -> PRGBA", FALSE);
+    test_conversion(&testdata_32bppRGBA, &testdata_32bppBGRA, "RGBA -> BGRA", FALSE);
+    test_conversion(&testdata_32bppBGRA, &testdata_32bppRGBA, "BGRA -> RGBA", FALSE);
+    test_conversion(&testdata_32bppRGB, &testdata_32bppBGR, "RGB -> BGR", FALSE);
 
     test_conversion(&testdata_24bppBGR, &testdata_24bppBGR, "24bppBGR -> 24bppBGR", FALSE);
     test_conversion(&testdata_24bppBGR, &testdata_24bppRGB, "24bppBGR -> 24bppRGB", FALSE);
@@ -1875,6 +1889,7 @@ START_TEST(converter)
 
     test_conversion(&testdata_32bppBGR, &testdata_24bppRGB, "32bppBGR -> 24bppRGB", FALSE);
     test_conversion(&testdata_24bppRGB, &testdata_32bppBGR, "24bppRGB -> 32bppBGR", FALSE);
+    test_conversion(&testdata_24bppBGR, &testdata_32bppBGRA, "24bppBGR -> 32bppBGRA", FALSE);
     test_conversion(&testdata_32bppBGRA, &testdata_24bppRGB, "32bppBGRA -> 24bppRGB", FALSE);
     test_conversion(&testdata_32bppRGBA, &testdata_24bppBGR, "32bppRGBA -> 24bppBGR", FALSE);
 
@@ -90,6 +90,9 @@ struct window
     WCHAR           *text;            /* window caption text */
     data_size_t      text_len;        /* length of window caption */
     unsigned int     paint_flags;     /* various painting flags */
+    struct region   *vis_region;      /* cached visible region (relative to window) */
+    unsigned int     vis_flags;       /* DCX flags used to compute the cached visible region */
+    unsigned int     vis_serial;      /* value of visible_region_serial when the cache was filled */
     int              prop_inuse;      /* number of in-use window properties */
     int              prop_alloc;      /* number of allocated window properties */
     struct property *properties;      /* window properties array */
@@ -118,6 +121,12 @@ struct user_handle_array
 
 static const rectangle_t empty_rect;
 
+/* incremented whenever anything that affects visible regions changes */
+static unsigned int visible_region_serial = 1;
+
+/* flags that affect the result of get_visible_region */
+#define VIS_REGION_FLAGS (DCX_PARENTCLIP | DCX_WINDOW | DCX_CLIPCHILDREN)
+
 /* global window pointers */
 static struct window *shell_window;
 static struct window *shell_listview;
@@ -188,9 +197,17 @@ static unsigned int get_monitor_dpi( struct window *win )
     return win->dpi ? win->dpi : USER_DEFAULT_SCREEN_DPI;
 }
 
+/* invalidate the cached visible regions of all windows */
+static inline void invalidate_visible_regions(void)
+{
+    visible_region_serial++;
+}
+
 /* link a window at the right place in the siblings list */
 static void link_window( struct window *win, struct window *previous )
 {
+    invalidate_visible_regions();
+
     if (previous == WINPTR_NOTOPMOST)
     {
         if (!(win->ex_style & WS_EX_TOPMOST) && win->is_linked) return;  /* nothing to do */
@@ -248,6 +265,8 @@ static int set_parent_window( struct window *win, struct window *parent )
 {
     struct window *ptr;
 
+    invalidate_visible_regions();
+
     /* make sure parent is not a child of window */
     for (ptr = parent; ptr; ptr = ptr->parent)
     {
@@ -509,6 +528,9 @@ static struct window *create_window( struct window *parent, struct window *owner
     win->text           = NULL;
     win->text_len       = 0;
     win->paint_flags    = 0;
+    win->vis_region     = NULL;
+    win->vis_flags      = 0;
+    win->vis_serial     = 0;
     win->prop_inuse     = 0;
     win->prop_alloc     = 0;
     win->properties     = NULL;
@@ -1018,7 +1040,7 @@ static inline struct window *get_top_clipping_window( struct window *win )
 
 
 /* compute the visible region of a window, in window coordinates */
-static struct region *get_visible_region( struct window *win, unsigned int flags )
+static struct region *compute_visible_region( struct window *win, unsigned int flags )
 {
     struct region *tmp = NULL, *region;
     int offset_x, offset_y;
@@ -1097,6 +1119,31 @@ error:
 }
 
 
+/* get the visible region of a window, in window coordinates; the caller must free it */
+static struct region *get_visible_region( struct window *win, unsigned int flags )
+{
+    struct region *region;
+
+    flags &= VIS_REGION_FLAGS;
+    if (win->vis_region && win->vis_serial == visible_region_serial && win->vis_flags == flags)
+    {
+        if (!(region = create_empty_region())) return NULL;
+        return copy_region( region, win->vis_region );
+    }
+
+    if (!(region = compute_visible_region( win, flags ))) return NULL;
+
+    if (!win->vis_region && !(win->vis_region = create_empty_region())) return region;
+    if (copy_region( win->vis_region, region ))
+    {
+        win->vis_flags  = flags;
+        win->vis_serial = visible_region_serial;
+    }
+    else win->vis_serial = 0;
+    return region;
+}
+
+
 /* clip all children with a custom pixel format out of the visible region */
 static struct region *clip_pixel_format_children( struct window *parent, struct region *parent_clip,
                                                   struct region *region, int offset_x, int offset_y )
@@ -1719,6 +1766,8 @@ static void set_window_pos( struct window *win, struct window *previous,
         }
     }
 
+    invalidate_visible_regions();
+
     /* reset cursor clip rectangle when the desktop changes size */
     if (win == win->desktop->top_window) win->desktop->cursor.clip = *window_rect;
 
@@ -1857,6 +1906,7 @@ static void set_window_region( struct window *win, struct region *region, int re
 
     if (win->win_region) free_region( win->win_region );
     win->win_region = region;
+    invalidate_visible_regions();
 
     /* expose anything revealed by the change */
     if (old_vis_rgn && ((exposed_rgn = expose_window( win, &win->window_rect, old_vis_rgn ))))
@@ -1878,6 +1928,7 @@ void destroy_window( struct window *win )
     {
         struct region *vis_rgn = get_visible_region( win, DCX_WINDOW );
         win->style &= ~WS_VISIBLE;
+        invalidate_visible_regions();
         if (vis_rgn)
         {
             struct region *exposed_rgn = expose_window( win, &win->window_rect, vis_rgn );
@@ -1904,6 +1955,7 @@ void destroy_window( struct window *win )
     free_user_handle( win->handle );
     destroy_properties( win );
     list_remove( &win->entry );
+    invalidate_visible_regions();
     if (is_desktop_window(win))
     {
         struct desktop *desktop = win->desktop;
@@ -1919,6 +1971,7 @@ void destroy_window( struct window *win )
     detach_window_thread( win );
     if (win->win_region) free_region( win->win_region );
     if (win->update_region) free_region( win->update_region );
+    if (win->vis_region) free_region( win->vis_region );
     if (win->class) release_class( win->class );
     free( win->text );
     memset( win, 0x55, sizeof(*win) + win->nb_extra_bytes - 1 );
@@ -2132,6 +2185,7 @@ DECL_HANDLER(set_window_info)
     reply->old_instance  = win->instance;
     reply->old_user_data = win->user_data;
     if (req->flags & SET_WIN_STYLE) win->style = req->style;
+    if (req->flags & (SET_WIN_STYLE | SET_WIN_EXSTYLE)) invalidate_visible_regions();
     if (req->flags & SET_WIN_EXSTYLE)
     {
         /* WS_EX_TOPMOST can only be changed for unlinked windows */
@@ -2670,6 +2724,7 @@ DECL_HANDLER(update_window_zorder)
         {
             list_remove( &win->entry );
             list_add_before( &ptr->entry, &win->entry );
+            invalidate_visible_regions();
         }
         break;
     }